@@ -1,11 +1,28 @@
 #include<bits/stdc++.h>
 #include<fstream>
 #include<sstream>
+#if defined(__x86_64__) || defined(__i386__)
+#include<x86intrin.h>
+#endif
+#ifdef __linux__
+#include<arpa/inet.h>
+#include<netinet/in.h>
+#include<netinet/tcp.h>
+#include<sys/epoll.h>
+#include<sys/file.h>
+#include<sys/socket.h>
+#include<sys/stat.h>
+#include<sys/un.h>
+#include<unistd.h>
+#include<csignal>
+#include "market_feed.h"
+#endif
 
 using namespace std;
 
 // Forward declarations for classes
 class MarketDataLoader;
+class MarketDataIndex;
 class Portfolio;
 class Stock;
 class Order;
@@ -17,34 +34,342 @@ class RSIStrategy;
 class MeanReversionStrategy;
 class TradeEngine;
 
-enum class OrderType { MARKET, LIMIT };
+enum class OrderType { MARKET, LIMIT, STOP, STOP_LIMIT, TRAILING_STOP };
+
+
+// ---------------- Latency instrumentation ----------------
+// Scoped probes record into per-thread log-linear histograms that are merged when read.
+// Build with -DTMS_DISABLE_PROFILING to compile every probe out.
+// PROBE_OVERHEAD only times empty scopes for probeOverhead() and is not listed with the others.
+enum class Probe { LOAD_COMPANY_DATA, APPLY_STRATEGY, EXECUTE_ORDER, MARKET_SELL, LIMIT_SELL, SUBMIT_ORDER, PRICE_UPDATE, SAVE_PORTFOLIO, LOG_TRANSACTION, PROBE_OVERHEAD, COUNT };
+
+const char* probeName(Probe probe) {
+    switch (probe) {
+        case Probe::LOAD_COMPANY_DATA: return "loadCompanyData";
+        case Probe::APPLY_STRATEGY: return "applyStrategy";
+        case Probe::EXECUTE_ORDER: return "executeOrder";
+        case Probe::MARKET_SELL: return "MarketSell";
+        case Probe::LIMIT_SELL: return "LimitSell";
+        case Probe::SUBMIT_ORDER: return "submitOrder";
+        case Probe::PRICE_UPDATE: return "onPriceUpdate";
+        case Probe::SAVE_PORTFOLIO: return "savePortfolio";
+        case Probe::LOG_TRANSACTION: return "logTransaction";
+        case Probe::PROBE_OVERHEAD: return "probeOverhead";
+        default: return "unknown";
+    }
+}
 
+// Raw timestamp: TSC on x86, steady_clock nanoseconds elsewhere
+inline uint64_t readTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
 
-// function to stroe transactions
-void logTransaction(const string& orderType, const string& symbol, int quantity, double price, const string& transactionType) {
-    ofstream logFile("log.txt", ios::app);  // Open the log file in append mode
+class LatencyProfiler {
+public:
+    // 16 linear sub-buckets per power of two, so each bucket is within ~6% of its values
+    static constexpr int SUB_BUCKETS = 16;
+    static constexpr int BUCKETS = 61 * SUB_BUCKETS;
+
+    // Written only by its owning thread (relaxed load + store, no locked instructions),
+    // read concurrently by whoever merges
+    struct Histogram {
+        atomic<uint64_t> counts[BUCKETS];
+        atomic<uint64_t> total;
+        atomic<uint64_t> sum;
+        atomic<uint64_t> max;
+
+        Histogram() {
+            for (auto& c : counts) c.store(0, memory_order_relaxed);
+            total.store(0, memory_order_relaxed);
+            sum.store(0, memory_order_relaxed);
+            max.store(0, memory_order_relaxed);
+        }
+
+        void record(uint64_t ticks) {
+            bump(counts[bucketOf(ticks)], 1);
+            bump(total, 1);
+            bump(sum, ticks);
+            if (ticks > max.load(memory_order_relaxed)) max.store(ticks, memory_order_relaxed);
+        }
+
+    private:
+        static void bump(atomic<uint64_t>& counter, uint64_t by) {
+            counter.store(counter.load(memory_order_relaxed) + by, memory_order_relaxed);
+        }
+    };
+
+    struct Stats {
+        uint64_t count = 0;
+        double mean = 0, p50 = 0, p99 = 0, p999 = 0, max = 0;  // nanoseconds
+    };
+
+    static void record(Probe probe, uint64_t ticks) {
+        local()[(int)probe].record(ticks);
+    }
+
+    // Merge every thread's histogram for a probe
+    static Stats collect(Probe probe) {
+        vector<uint64_t> merged(BUCKETS, 0);
+        uint64_t total = 0, sum = 0, maxTicks = 0;
+        {
+            lock_guard<mutex> lock(registryMutex());
+            for (Histogram* histograms : registry()) {
+                Histogram& h = histograms[(int)probe];
+                for (int b = 0; b < BUCKETS; ++b) {
+                    merged[b] += h.counts[b].load(memory_order_relaxed);
+                }
+                total += h.total.load(memory_order_relaxed);
+                sum += h.sum.load(memory_order_relaxed);
+                maxTicks = max(maxTicks, h.max.load(memory_order_relaxed));
+            }
+        }
+
+        Stats stats;
+        double nsPerTick = nanosecondsPerTick();
+        stats.count = total;
+        if (total == 0) return stats;
+        stats.mean = sum * nsPerTick / total;
+        stats.max = maxTicks * nsPerTick;
+        stats.p50 = min(percentile(merged, total, 0.50) * nsPerTick, stats.max);
+        stats.p99 = min(percentile(merged, total, 0.99) * nsPerTick, stats.max);
+        stats.p999 = min(percentile(merged, total, 0.999) * nsPerTick, stats.max);
+        return stats;
+    }
+
+    // Cost of one empty PROFILE_SCOPE, in nanoseconds (defined after ScopedTimer)
+    static double probeOverhead();
+
+    static string toJson() {
+        stringstream json;
+        json << fixed << setprecision(1);
+#ifdef TMS_DISABLE_PROFILING
+        json << "{\"enabled\": false, \"unit\": \"ns\", \"probes\": []}";
+#else
+        json << "{\"enabled\": true, \"unit\": \"ns\", \"probe_overhead\": " << probeOverhead() << ", \"probes\": [";
+        for (int p = 0; p < (int)Probe::PROBE_OVERHEAD; ++p) {
+            Stats stats = collect((Probe)p);
+            json << (p == 0 ? "" : ", ")
+                 << "{\"name\": \"" << probeName((Probe)p) << "\", \"count\": " << stats.count
+                 << ", \"mean\": " << stats.mean << ", \"p50\": " << stats.p50 << ", \"p99\": " << stats.p99
+                 << ", \"p999\": " << stats.p999 << ", \"max\": " << stats.max << "}";
+        }
+        json << "]}";
+#endif
+        return json.str();
+    }
+
+    static void printSummary() {
+#ifdef TMS_DISABLE_PROFILING
+        cout << "Latency profiling was disabled at compile time." << endl;
+#else
+        cout << fixed << setprecision(1);
+        cout << left << setw(18) << "Probe" << right << setw(10) << "Count" << setw(12) << "p50 (ns)"
+             << setw(12) << "p99 (ns)" << setw(12) << "p999 (ns)" << setw(12) << "max (ns)" << endl;
+        for (int p = 0; p < (int)Probe::PROBE_OVERHEAD; ++p) {
+            Stats stats = collect((Probe)p);
+            cout << left << setw(18) << probeName((Probe)p) << right << setw(10) << stats.count << setw(12) << stats.p50
+                 << setw(12) << stats.p99 << setw(12) << stats.p999 << setw(12) << stats.max << endl;
+        }
+        cout << "Probe overhead: " << probeOverhead() << " ns" << endl;
+        cout << defaultfloat << setprecision(6);
+#endif
+    }
+
+private:
+    static int bucketOf(uint64_t v) {
+        if (v < SUB_BUCKETS) return (int)v;
+        int msb = 63 - __builtin_clzll(v);
+        return (msb - 3) * SUB_BUCKETS + (int)((v >> (msb - 4)) & (SUB_BUCKETS - 1));
+    }
+
+    // Midpoint of the values that land in a bucket
+    static double bucketValue(int bucket) {
+        if (bucket < SUB_BUCKETS) return bucket;
+        int msb = bucket / SUB_BUCKETS + 3;
+        double width = ldexp(1.0, msb - 4);
+        return (SUB_BUCKETS + bucket % SUB_BUCKETS) * width + width / 2;
+    }
+
+    static double percentile(const vector<uint64_t>& counts, uint64_t total, double q) {
+        uint64_t rank = (uint64_t)ceil(q * total);
+        uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; ++b) {
+            seen += counts[b];
+            if (seen >= rank && counts[b] > 0) return bucketValue(b);
+        }
+        return 0;
+    }
+
+    // Each thread gets its own histograms on first use; they are never freed so
+    // results from finished threads stay readable
+    static Histogram* local() {
+        thread_local Histogram* histograms = registerThread();
+        return histograms;
+    }
+
+    static Histogram* registerThread() {
+        Histogram* histograms = new Histogram[(int)Probe::COUNT];
+        lock_guard<mutex> lock(registryMutex());
+        registry().push_back(histograms);
+        return histograms;
+    }
+
+    static vector<Histogram*>& registry() {
+        static vector<Histogram*> threads;
+        return threads;
+    }
+
+    static mutex& registryMutex() {
+        static mutex m;
+        return m;
+    }
+
+    // TSC rate measured against steady_clock since startup
+    static inline const uint64_t startTicks = readTicks();
+    static inline const chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+    static double nanosecondsPerTick() {
+#if defined(__x86_64__) || defined(__i386__)
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        if (now - startTime < chrono::milliseconds(10)) {
+            this_thread::sleep_for(chrono::milliseconds(10) - (now - startTime));
+            now = chrono::steady_clock::now();
+        }
+        double elapsedNs = (double)chrono::duration_cast<chrono::nanoseconds>(now - startTime).count();
+        return elapsedNs / (readTicks() - startTicks);
+#else
+        return 1.0;
+#endif
+    }
+};
+
+class ScopedTimer {
+    Probe probe;
+    uint64_t start;
+public:
+    ScopedTimer(Probe p) : probe(p), start(readTicks()) {}
+    ~ScopedTimer() { LatencyProfiler::record(probe, readTicks() - start); }
+};
+
+#ifndef TMS_DISABLE_PROFILING
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(probe) ScopedTimer PROFILE_CONCAT(profileScope, __LINE__)(probe)
+#else
+#define PROFILE_SCOPE(probe)
+#endif
+
+double LatencyProfiler::probeOverhead() {
+    const int samples = 100000;
+    uint64_t start = readTicks();
+    for (int i = 0; i < samples; ++i) {
+        PROFILE_SCOPE(Probe::PROBE_OVERHEAD);
+    }
+    return (readTicks() - start) * nanosecondsPerTick() / samples;
+}
+
+
+// A line destined for one of the log files
+struct LogRecord {
+    const char* filename;
+    string line;
+};
+
+// When set, log lines are collected here (for a journal thread to write) instead of going straight to disk
+thread_local vector<LogRecord>* capturedLogs = nullptr;
+
+// Append one line to a log file, returns false if the file could not be opened
+bool writeLogLine(const char* filename, const string& line) {
+    if (capturedLogs != nullptr) {
+        capturedLogs->push_back({filename, line});
+        return true;
+    }
+
+    ofstream logFile(filename, ios::app);  // Open the log file in append mode
     if (!logFile.is_open()) {
-        cout << "Error: Could not open transaction log file." << endl;
-        return;
+        return false;
     }
+    logFile << line << endl;
+    return true;
+}
 
+// function to stroe transactions
+void logTransaction(const string& orderType, const string& symbol, int quantity, double price, const string& transactionType) {
+    PROFILE_SCOPE(Probe::LOG_TRANSACTION);
     double totalValue = quantity * price;
 
     // Log the transaction in CSV format: TransactionType, OrderType, Symbol, Quantity, Price, TotalValue
-    logFile << transactionType << ", "
-            << orderType << ", "
-            << symbol << ", "
-            << quantity << ", "
-            << price << ", "
-            << totalValue << endl;
+    stringstream line;
+    line << transactionType << ", "
+         << orderType << ", "
+         << symbol << ", "
+         << quantity << ", "
+         << price << ", "
+         << totalValue;
+
+    if (!writeLogLine("log.txt", line.str())) {
+        cout << "Error: Could not open transaction log file." << endl;
+    }
+}
+
+// Split days since 1970-01-01 into year, month and day of month
+void civilFromDays(int day, int& y, int& m, int& d) {
+    day += 719468;
+    int era = (day >= 0 ? day : day - 146096) / 146097;
+    int dayOfEra = day - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int mp = (5 * dayOfYear + 2) / 153;
+    d = dayOfYear - (153 * mp + 2) / 5 + 1;
+    m = mp + (mp < 10 ? 3 : -9);
+    y = yearOfEra + era * 400 + (m <= 2);
+}
+
+// Convert a "YYYY-MM-DD" date into days since 1970-01-01, returns INT_MIN if the date is malformed,
+// has anything but whitespace after it, or does not exist (e.g. 2023-02-29)
+int parseDate(const string& date) {
+    int y, m, d;
+    char sep1, sep2;
+    stringstream ss(date);
+    if (!(ss >> y >> sep1 >> m >> sep2 >> d) || sep1 != '-' || sep2 != '-' || m < 1 || m > 12 || d < 1 || d > 31) {
+        return INT_MIN;
+    }
+    ss >> ws;
+    if (!ss.eof()) return INT_MIN;  // trailing junk such as "2024-1-5x"
+
+    // Days from civil date (proleptic Gregorian calendar)
+    int year = y - (m <= 2);
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    int day = era * 146097 + dayOfEra - 719468;
+
+    // Day 31 of a 30 day month would otherwise roll into the next month
+    int cy, cm, cd;
+    civilFromDays(day, cy, cm, cd);
+    return cy == y && cm == m && cd == d ? day : INT_MIN;
+}
 
-    logFile.close();  // Close the log file after writing
+// Convert days since 1970-01-01 back into a "YYYY-MM-DD" date
+string formatDate(int day) {
+    int y, m, d;
+    civilFromDays(day, y, m, d);
 
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d", y, m, d);
+    return buffer;
 }
+
 class MarketDataLoader {
 public:
     struct MarketData {
         string date;
+        int day;  // date parsed into days since 1970-01-01
         double openPrice, highPrice, lowPrice, closePrice, volume;
         double gain, loss, avgGain, avgLoss, rsi, movingAvg, momentum;
         double upperThreshold, lowerThreshold;
@@ -67,6 +392,7 @@ public:
 
 private:
     vector<MarketData> loadCompanyData(const string& filename) {
+        PROFILE_SCOPE(Probe::LOAD_COMPANY_DATA);
         vector<MarketData> data;
         ifstream file(filename);
         if (!file.is_open()) {
@@ -88,6 +414,11 @@ private:
             try {
                 // Parse each value, separated by commas
                 getline(ss, entry.date, ',');
+                entry.day = parseDate(entry.date);
+                if (entry.day == INT_MIN) {
+                    cout << "Error: Malformed date in line: " << line << endl;
+                    continue;
+                }
                 ss >> entry.openPrice;
                 ss.ignore(); // to ignore the comma
                 ss >> entry.highPrice;
@@ -128,6 +459,11 @@ private:
             data.push_back(entry);
         }
 
+        // Keep bars in date order so they can be binary searched
+        if (!is_sorted(data.begin(), data.end(), [](const MarketData& a, const MarketData& b) { return a.day < b.day; })) {
+            stable_sort(data.begin(), data.end(), [](const MarketData& a, const MarketData& b) { return a.day < b.day; });
+        }
+
         return data;
     }
 
@@ -142,6 +478,330 @@ public:
     }
 };
 
+// Date index over loaded market data for range and cross-symbol queries.
+// Holds pointers into the market data map, so the map must outlive the index and not be modified.
+class MarketDataIndex {
+public:
+    using MarketData = MarketDataLoader::MarketData;
+
+    // Non-owning view over a contiguous run of bars
+    struct Span {
+        const MarketData* first = nullptr;
+        const MarketData* last = nullptr;
+
+        const MarketData* begin() const { return first; }
+        const MarketData* end() const { return last; }
+        size_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+        const MarketData& operator[](size_t i) const { return first[i]; }
+    };
+
+    MarketDataIndex(const unordered_map<string, vector<MarketData>>& marketData) {
+        for (const auto& entry : marketData) {
+            symbols.push_back(entry.first);
+        }
+        sort(symbols.begin(), symbols.end());
+
+        // Global calendar is the union of every symbol's trading days
+        for (const auto& symbol : symbols) {
+            for (const auto& bar : marketData.at(symbol)) {
+                calendarDays.push_back(bar.day);
+            }
+        }
+        sort(calendarDays.begin(), calendarDays.end());
+        calendarDays.erase(unique(calendarDays.begin(), calendarDays.end()), calendarDays.end());
+
+        series.resize(symbols.size());
+        for (size_t s = 0; s < symbols.size(); ++s) {
+            const vector<MarketData>& data = marketData.at(symbols[s]);
+            SymbolSeries& sr = series[s];
+            sr.bars.first = data.data();
+            sr.bars.last = data.data() + data.size();
+            sr.days.reserve(data.size());
+            for (const auto& bar : data) {
+                sr.days.push_back(bar.day);
+            }
+
+            // For each calendar day, the latest bar on or before it (-1 if the symbol has not started trading)
+            sr.asOf.resize(calendarDays.size());
+            int bar = -1;
+            for (size_t c = 0; c < calendarDays.size(); ++c) {
+                while (bar + 1 < (int)sr.days.size() && sr.days[bar + 1] <= calendarDays[c]) {
+                    ++bar;
+                }
+                sr.asOf[c] = bar;
+            }
+            symbolIndex[symbols[s]] = s;
+        }
+    }
+
+    // Bars for a symbol with fromDay <= day <= toDay
+    Span range(const string& symbol, int fromDay, int toDay) const {
+        const SymbolSeries* sr = find(symbol);
+        if (sr == nullptr || fromDay > toDay) {
+            return Span();
+        }
+        size_t lo = lower_bound(sr->days.begin(), sr->days.end(), fromDay) - sr->days.begin();
+        size_t hi = upper_bound(sr->days.begin(), sr->days.end(), toDay) - sr->days.begin();
+        return Span{sr->bars.first + lo, sr->bars.first + hi};
+    }
+
+    Span range(const string& symbol, const string& fromDate, const string& toDate) const {
+        return range(symbol, parseDate(fromDate), parseDate(toDate));
+    }
+
+    // Bar traded exactly on the given day, or nullptr
+    const MarketData* barOn(const string& symbol, int day) const {
+        const SymbolSeries* sr = find(symbol);
+        if (sr == nullptr) {
+            return nullptr;
+        }
+        auto it = lower_bound(sr->days.begin(), sr->days.end(), day);
+        if (it == sr->days.end() || *it != day) {
+            return nullptr;
+        }
+        return sr->bars.first + (it - sr->days.begin());
+    }
+
+    // Latest bar on or before the given day, or nullptr
+    const MarketData* barAsOf(const string& symbol, int day) const {
+        const SymbolSeries* sr = find(symbol);
+        if (sr == nullptr) {
+            return nullptr;
+        }
+        size_t count = upper_bound(sr->days.begin(), sr->days.end(), day) - sr->days.begin();
+        return count == 0 ? nullptr : sr->bars.first + count - 1;
+    }
+
+    // One bar per symbol (in symbols() order) for the given day.
+    // With carryForward, symbols that did not trade that day report their previous bar.
+    vector<const MarketData*> slice(int day, bool carryForward = true) const {
+        vector<const MarketData*> result(symbols.size(), nullptr);
+        int pos = int(upper_bound(calendarDays.begin(), calendarDays.end(), day) - calendarDays.begin()) - 1;
+        if (pos < 0) {
+            return result;
+        }
+        for (size_t s = 0; s < series.size(); ++s) {
+            int bar = series[s].asOf[pos];
+            if (bar < 0) continue;
+            const MarketData* candidate = series[s].bars.first + bar;
+            if (carryForward || candidate->day == day) {
+                result[s] = candidate;
+            }
+        }
+        return result;
+    }
+
+    const vector<string>& getSymbols() const { return symbols; }
+    const vector<int>& getCalendar() const { return calendarDays; }
+
+private:
+    struct SymbolSeries {
+        Span bars;
+        vector<int> days;   // bar days kept contiguous for binary search
+        vector<int> asOf;   // calendar position -> bar index
+    };
+
+    const SymbolSeries* find(const string& symbol) const {
+        auto it = symbolIndex.find(symbol);
+        return it == symbolIndex.end() ? nullptr : &series[it->second];
+    }
+
+    vector<string> symbols;
+    unordered_map<string, size_t> symbolIndex;
+    vector<SymbolSeries> series;
+    vector<int> calendarDays;
+};
+
+enum class Timeframe { DAILY, WEEKLY, MONTHLY };
+
+// Streaming OHLCV aggregation: rolls bars up into coarser bars and builds bars from raw ticks.
+// Every builder makes a single pass and writes straight into the output vector.
+class BarAggregator {
+public:
+    using MarketData = MarketDataLoader::MarketData;
+
+    struct Tick {
+        long long timestamp;  // seconds since 1970-01-01
+        double price;
+        double volume;
+    };
+
+    // Roll date ordered bars up into weekly or monthly bars.
+    // Each output bar is labelled with the date of the last bar in its period, and the
+    // indicator columns are recomputed over the aggregated bars (see computeIndicators).
+    static void resample(const vector<MarketData>& bars, Timeframe timeframe, vector<MarketData>& out) {
+        out.clear();
+        if (timeframe == Timeframe::DAILY) {
+            out = bars;
+            return;
+        }
+        out.reserve(bars.size() / (timeframe == Timeframe::WEEKLY ? 5 : 20) + 1);
+
+        int currentPeriod = 0;
+        for (const auto& bar : bars) {
+            int period = periodOf(bar.day, timeframe);
+            if (out.empty() || period != currentPeriod) {
+                out.push_back(bar);
+                currentPeriod = period;
+                continue;
+            }
+
+            MarketData& agg = out.back();
+            double open = agg.openPrice;
+            double high = max(agg.highPrice, bar.highPrice);
+            double low = min(agg.lowPrice, bar.lowPrice);
+            double volume = agg.volume + bar.volume;
+            agg = bar;
+            agg.openPrice = open;
+            agg.highPrice = high;
+            agg.lowPrice = low;
+            agg.volume = volume;
+        }
+        computeIndicators(out);
+    }
+
+    // Resample every symbol, spreading symbols across worker threads
+    static unordered_map<string, vector<MarketData>> resampleAll(const unordered_map<string, vector<MarketData>>& marketData, Timeframe timeframe) {
+        vector<const pair<const string, vector<MarketData>>*> jobs;
+        for (const auto& entry : marketData) {
+            jobs.push_back(&entry);
+        }
+
+        vector<vector<MarketData>> results(jobs.size());
+        atomic<size_t> next(0);
+        auto worker = [&]() {
+            for (size_t i = next++; i < jobs.size(); i = next++) {
+                resample(jobs[i]->second, timeframe, results[i]);
+            }
+        };
+
+        size_t threadCount = min<size_t>(jobs.size(), max(1u, thread::hardware_concurrency()));
+        vector<thread> threads;
+        for (size_t t = 1; t < threadCount; ++t) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& th : threads) {
+            th.join();
+        }
+
+        unordered_map<string, vector<MarketData>> resampled;
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            resampled[jobs[i]->first] = move(results[i]);
+        }
+        return resampled;
+    }
+
+    // Build fixed interval time bars from time ordered ticks, false if the interval is not positive
+    static bool timeBars(const vector<Tick>& ticks, long long intervalSeconds, vector<MarketData>& out) {
+        out.clear();
+        if (intervalSeconds <= 0) return false;
+        long long currentBucket = 0;
+        for (const auto& tick : ticks) {
+            long long bucket = floorDiv(tick.timestamp, intervalSeconds);
+            if (out.empty() || bucket != currentBucket) {
+                out.push_back(barFromTick(tick));
+                currentBucket = bucket;
+            } else {
+                addTick(out.back(), tick);
+            }
+        }
+        computeIndicators(out);
+        return true;
+    }
+
+    // Build bars that each close once they have traded at least volumePerBar shares,
+    // false if volumePerBar is not positive
+    static bool volumeBars(const vector<Tick>& ticks, double volumePerBar, vector<MarketData>& out) {
+        out.clear();
+        if (!(volumePerBar > 0.0)) return false;
+        bool barOpen = false;
+        for (const auto& tick : ticks) {
+            if (!barOpen) {
+                out.push_back(barFromTick(tick));
+                barOpen = true;
+            } else {
+                addTick(out.back(), tick);
+            }
+            if (out.back().volume >= volumePerBar) {
+                barOpen = false;
+            }
+        }
+        computeIndicators(out);
+        return true;
+    }
+
+    // Fill the indicator columns the way the CSV files use them: 14 bar Wilder RSI, 10 bar moving
+    // average and momentum, and moving average +/- 2 standard deviations. The RSI averages are the
+    // simple mean of the changes so far up to the 14th change, then Wilder smoothed.
+    static void computeIndicators(vector<MarketData>& bars) {
+        double avgGain = 0.0, avgLoss = 0.0;
+        for (size_t i = 0; i < bars.size(); ++i) {
+            MarketData& bar = bars[i];
+            double change = i == 0 ? 0.0 : bar.closePrice - bars[i - 1].closePrice;
+            bar.gain = change > 0 ? round2(change) : 0.0;
+            bar.loss = change < 0 ? round2(-change) : 0.0;
+            if (i > 0) {
+                double period = (double)min<size_t>(i, 14);
+                avgGain = (avgGain * (period - 1) + bar.gain) / period;
+                avgLoss = (avgLoss * (period - 1) + bar.loss) / period;
+            }
+            bar.avgGain = round2(avgGain);
+            bar.avgLoss = round2(avgLoss);
+            if (avgLoss > 0.0) bar.rsi = round2(100.0 - 100.0 / (1.0 + avgGain / avgLoss));
+            else bar.rsi = avgGain > 0.0 ? 100.0 : 50.0;  // only gains is overbought, no movement is neutral
+
+            size_t first = i >= 9 ? i - 9 : 0;
+            double sum = 0.0, sumSquares = 0.0;
+            for (size_t j = first; j <= i; ++j) {
+                sum += bars[j].closePrice;
+                sumSquares += bars[j].closePrice * bars[j].closePrice;
+            }
+            int n = (int)(i - first + 1);
+            double mean = sum / n;
+            double stddev = sqrt(max(0.0, sumSquares / n - mean * mean));
+            bar.movingAvg = round2(mean);
+            bar.momentum = round2(bar.closePrice - bars[first].closePrice);
+            bar.upperThreshold = round2(mean + 2 * stddev);
+            bar.lowerThreshold = round2(mean - 2 * stddev);
+        }
+    }
+
+private:
+    static double round2(double value) { return round(value * 100.0) / 100.0; }
+
+    static long long floorDiv(long long a, long long b) {
+        return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+    }
+
+    // Weeks start on Monday (1970-01-01 was a Thursday), months are counted from year 0
+    static int periodOf(int day, Timeframe timeframe) {
+        if (timeframe == Timeframe::WEEKLY) {
+            return (int)floorDiv(day + 3, 7);
+        }
+        int y, m, d;
+        civilFromDays(day, y, m, d);
+        return y * 12 + (m - 1);
+    }
+
+    static MarketData barFromTick(const Tick& tick) {
+        MarketData bar{};
+        bar.day = (int)floorDiv(tick.timestamp, 86400);
+        bar.date = formatDate(bar.day);
+        bar.openPrice = bar.highPrice = bar.lowPrice = bar.closePrice = tick.price;
+        bar.volume = tick.volume;
+        return bar;
+    }
+
+    static void addTick(MarketData& bar, const Tick& tick) {
+        bar.highPrice = max(bar.highPrice, tick.price);
+        bar.lowPrice = min(bar.lowPrice, tick.price);
+        bar.closePrice = tick.price;
+        bar.volume += tick.volume;
+    }
+};
+
 class Order {
 protected:
     string symbol;
@@ -156,26 +816,21 @@ public:
     double getPrice() const { return price; }
 };
 
+// MarketOrder and LimitOrder describe buy orders for TradeEngine::executeOrder, which runs them
+// through OrderManager; execute() only reports a fill, OrderManager logs it.
 class MarketOrder : public Order {
 public:
     MarketOrder(string symbol, int quantity) : Order(symbol, quantity, 0.0) {}
-    void execute(double currentPrice) override {
-        cout << "Executing Market Order: " << quantity << " shares of " << symbol << " at $" << currentPrice << endl;
-        logTransaction("Market Order", symbol, quantity, currentPrice, "BUY"); // calling logTransaction() to store the MarketOrder
+    void execute(double fillPrice) override {
+        cout << "Executing Market Order: " << quantity << " shares of " << symbol << " at $" << fillPrice << endl;
     }
 };
 
 class LimitOrder : public Order {
 public:
     LimitOrder(string symbol, int quantity, double price) : Order(symbol, quantity, price) {}
-    void execute(double currentPrice) override {
-        if (currentPrice <= price) {
-            cout << "Executing Limit Order: " << quantity << " shares of " << symbol << " at $" << price << endl;
-            logTransaction("Limit Order", symbol, quantity, price, "BUY");
-        } else {
-            cout << "Limit Order for " << symbol << " not executed. Current price ($" << currentPrice 
-                 << ") is higher than limit price ($" << price << ")." << endl;
-        }
+    void execute(double fillPrice) override {
+        cout << "Executing Limit Order: " << quantity << " shares of " << symbol << " at $" << fillPrice << endl;
     }
 };
 
@@ -223,14 +878,23 @@ public:
 class Portfolio {
     unordered_map<string, Stock> stocks;
     double cashBalance;
+    bool autoSave = true;  // write portfolio.txt after every change
+
+    void persist() {
+        if (autoSave) savePortfolio();
+    }
 
 public:
     Portfolio(double initialBalance = 100000) : cashBalance(initialBalance) {
         loadPortfolio();  // Load saved portfolio data at the start
     }
 
+    // Headless modes turn this off and save once at the end
+    void setAutoSave(bool enabled) { autoSave = enabled; }
+
     // Save the portfolio state to file
     void savePortfolio() {
+        PROFILE_SCOPE(Probe::SAVE_PORTFOLIO);
         ofstream file("portfolio.txt");
         if (!file.is_open()) {
             cout << "Error: Could not open portfolio file for saving." << endl;
@@ -277,7 +941,7 @@ public:
         } else {
             stocks[stock.getSymbol()] = stock;
         }
-        savePortfolio();  // Save portfolio after adding stock
+        persist();  // Save portfolio after adding stock
     }
 
     bool buyStock(const string& symbol, int quantity, double price) {
@@ -290,17 +954,15 @@ public:
         cashBalance -= totalCost;
         addStock(Stock(symbol, quantity, price));
         // logTransaction("Buy", symbol, quantity, price, "BUY");
-        savePortfolio();  // Save portfolio after buying stock
+        persist();  // Save portfolio after buying stock
         cout << "Bought " << quantity << " shares of " << symbol << " at $" << price << endl;
 
-        // Log transaction in "log_sell.txt"
-        ofstream buyLogFile("log_buy.txt", ios::app);
-        if (buyLogFile.is_open()) {
-            buyLogFile << symbol << ", Quantity: " << quantity << ", Price: $" 
-                        << price << ", Total: $" << quantity*price<< endl;
-            buyLogFile.close();
-        } else {
-            cout << "Error opening sell log file." << endl;
+        // Log transaction in "log_buy.txt"
+        stringstream buyLogLine;
+        buyLogLine << symbol << ", Quantity: " << quantity << ", Price: $" 
+                   << price << ", Total: $" << quantity*price;
+        if (!writeLogLine("log_buy.txt", buyLogLine.str())) {
+            cout << "Error opening buy log file." << endl;
         }
         return true;
     }
@@ -313,7 +975,7 @@ public:
             logTransaction("Sell", symbol, stocks[symbol].getQuantity(), currentPrice, "SELL");
             stocks.erase(symbol);
             cout << "Sold " << symbol << " for $" << stockValue << endl;
-            savePortfolio();  // Save portfolio after removing stock
+            persist();  // Save portfolio after removing stock
         } else {
             cout << "Stock " << symbol << " not found in portfolio." << endl;
         }
@@ -342,17 +1004,15 @@ public:
             stock = Stock(symbol, stock.getQuantity() - quantity, stock.getPurchasePrice());
         }
 
-        // Log transaction in "sell.txt"
-        ofstream sellLogFile("log_sell.txt", ios::app);
-        if (sellLogFile.is_open()) {
-            sellLogFile << "Sell " << symbol << ", Quantity: " << quantity << ", Price: $" 
-                        << sellPrice << ", Total: $" << saleProceeds << endl;
-            sellLogFile.close();
-        } else {
+        // Log transaction in "log_sell.txt"
+        stringstream sellLogLine;
+        sellLogLine << "Sell " << symbol << ", Quantity: " << quantity << ", Price: $" 
+                    << sellPrice << ", Total: $" << saleProceeds;
+        if (!writeLogLine("log_sell.txt", sellLogLine.str())) {
             cout << "Error opening sell log file." << endl;
         }
 
-        savePortfolio();  // Save updated portfolio
+        persist();  // Save updated portfolio
         cout << "Sold " << quantity << " shares of " << symbol << " at $" << sellPrice << endl;
         return true;
     }
@@ -365,6 +1025,9 @@ public:
         return totalValue;
     }
 
+    const unordered_map<string, Stock>& getStocks() const { return stocks; }
+    double getCashBalance() const { return cashBalance; }
+
     void printPortfolio() {
         cout << "Portfolio Summary:" << endl;
         cout << "Cash Balance: $" << cashBalance << endl;
@@ -535,174 +1198,2374 @@ public:
 };
 
 
-class TradeEngine {
-    MarketDataLoader& loader;
-    Portfolio& portfolio;
+// Compile-time configured versions of the strategies above for fixed production configurations.
+// Window sizes and thresholds are template parameters, so loop bounds are constants and a
+// StrategyPipeline can evaluate several strategies in one pass over the data.
+enum class Signal { NO_DATA, HOLD, BUY, SELL };
 
-public:
-    TradeEngine(MarketDataLoader& ld, Portfolio& pf) : loader(ld), portfolio(pf) {}
-
-    void executeOrder(Order* order, double currentPrice) {
-        if (MarketOrder* marketOrder = dynamic_cast<MarketOrder*>(order)) {
-            // Execute market order and buy stock
-            marketOrder->execute(currentPrice);
-            portfolio.buyStock(marketOrder->getSymbol(), marketOrder->getQuantity(), currentPrice);
-        } else if (LimitOrder* limitOrder = dynamic_cast<LimitOrder*>(order)) {
-            // Execute limit order and buy stock if conditions met
-            if (currentPrice <= limitOrder->getPrice()) {
-                limitOrder->execute(currentPrice);
-                portfolio.buyStock(limitOrder->getSymbol(), limitOrder->getQuantity(), currentPrice);
-            } else {
-                cout << "Limit Order for " << limitOrder->getSymbol() << " not executed. Price too high.\n";
-            }
-        }
+const char* signalName(Signal signal) {
+    switch (signal) {
+        case Signal::BUY: return "BUY";
+        case Signal::SELL: return "SELL";
+        case Signal::HOLD: return "HOLD";
+        default: return "NO DATA";
     }
+}
 
-    void executeStrategy(TradingStrategy* strategy, const unordered_map<string, vector<MarketDataLoader::MarketData>>& marketData) {
-        strategy->applyStrategy(marketData);
-    }
+// Each static strategy sees the trailing bars oldest first through accumulate(),
+// where age is the distance from the latest bar (0 = latest).
+template<int Period>
+struct StaticMovingAverage {
+    static constexpr int window = Period;
+    static const char* name() { return "Moving Average"; }
 
-    void MarketSell(const string& symbol, int quantity, double currentPrice) {
-        portfolio.sellStock(symbol, quantity, currentPrice);
-        logTransaction("Market Sell", symbol, quantity, currentPrice, "SELL");  // Log transaction
-    }
+    double sum = 0.0;
 
-    void LimitSell(const string& symbol, int quantity, double limitPrice, double currentPrice) {
-        if (currentPrice >= limitPrice) {
-            portfolio.sellStock(symbol, quantity, limitPrice);
-            logTransaction("Limit Sell", symbol, quantity, limitPrice, "SELL");  // Log transaction
-            cout << "Executed Limit Sell Order for " << quantity << " shares of " << symbol 
-                 << " at $" << limitPrice << endl;
-        } else {
-            cout << "Limit Sell Order not executed. Current price $" << currentPrice 
-                 << " is below limit price $" << limitPrice << endl;
-        }
-    }
+    void accumulate(const MarketDataLoader::MarketData& bar, int) { sum += bar.closePrice; }
 
+    Signal signal(const MarketDataLoader::MarketData& latest) const {
+        double movingAvg = sum / Period;
+        if (latest.closePrice < movingAvg) return Signal::BUY;
+        if (latest.closePrice > movingAvg) return Signal::SELL;
+        return Signal::HOLD;
+    }
 };
 
+template<int Period, int BuyThreshold, int SellThreshold>
+struct StaticRSI {
+    static constexpr int window = Period;
+    static const char* name() { return "RSI"; }
 
-// User interaction with the system
-void displayMenu() {
-    cout << "\n---- AutoTrader++ ----\n";
-    cout << "1. View Portfolio\n";
-    // cout << "2. View Latest Price of a Stock\n";
-    cout << "2. View Current Market\n";
-    cout << "3. Place a Market Order\n";
-    cout << "4. Place a Limit Order\n";
-    cout << "5. Execute a Trading Strategy\n";
-    cout << "6. Sell a Market Order\n";
-    cout << "7. Sell a Limit Order\n";
-    cout << "8. Exit\n";
-    cout << "Enter your choice: ";
-}
+    void accumulate(const MarketDataLoader::MarketData&, int) {}
 
-// *********************************************
-void parseLogLine(const string& logLine, string& transactionType, string& orderType, string& symbol, int& quantity, double& price, double& totalValue) {
-    stringstream ss(logLine);
-    string token;
+    Signal signal(const MarketDataLoader::MarketData& latest) const {
+        if (latest.rsi < BuyThreshold) return Signal::BUY;
+        if (latest.rsi > SellThreshold) return Signal::SELL;
+        return Signal::HOLD;
+    }
+};
 
-    getline(ss, transactionType, ',');
-    getline(ss, orderType, ',');
-    getline(ss, symbol, ',');
-    
-    getline(ss, token, ',');
-    quantity = stoi(token);
-    
-    getline(ss, token, ',');
-    price = stod(token);
-    
-    getline(ss, token, ',');
-    totalValue = stod(token);
-}
+// Deviation threshold is given in basis points (500 = 5%)
+template<int Period, int DeviationBasisPoints>
+struct StaticMeanReversion {
+    static constexpr int window = Period;
+    static const char* name() { return "Mean Reversion"; }
 
+    double sum = 0.0;
 
-void calculateTotalBuySell() {
-    ifstream logFile("log.txt");
-    if (!logFile.is_open()) {
-        cout << "Error: Could not open transaction log file." << endl;
-        return;
+    void accumulate(const MarketDataLoader::MarketData& bar, int) { sum += bar.closePrice; }
+
+    Signal signal(const MarketDataLoader::MarketData& latest) const {
+        constexpr double threshold = DeviationBasisPoints / 10000.0;
+        double movingAvg = sum / Period;
+        double deviation = (latest.closePrice - movingAvg) / movingAvg;
+        if (deviation < -threshold) return Signal::BUY;
+        if (deviation > threshold) return Signal::SELL;
+        return Signal::HOLD;
     }
+};
 
-    string logLine;
-    double totalBuyValue = 0.0;
-    double totalSellValue = 0.0;
+template<int Period>
+struct StaticMomentum {
+    static constexpr int window = Period;
+    static const char* name() { return "Momentum"; }
 
-    while (getline(logFile, logLine)) {
-        string transactionType, orderType, symbol;
-        int quantity;
-        double price, totalValue;
+    double previousPrice = 0.0;
 
-        parseLogLine(logLine, transactionType, orderType, symbol, quantity, price, totalValue);
+    void accumulate(const MarketDataLoader::MarketData& bar, int age) {
+        if (age == Period - 1) previousPrice = bar.closePrice;
+    }
 
-        if (transactionType == "BUY") {
-            totalBuyValue += totalValue;
-        } else if (transactionType == "SELL") {
-            totalSellValue += totalValue;
-        }
+    Signal signal(const MarketDataLoader::MarketData& latest) const {
+        double momentum = latest.closePrice - previousPrice;
+        if (momentum > 0) return Signal::BUY;
+        if (momentum < 0) return Signal::SELL;
+        return Signal::HOLD;
     }
+};
 
-    logFile.close();
+// Statically composed chain of strategies evaluated with one fused loop per symbol
+template<class... Strategies>
+class StrategyPipeline {
+public:
+    static constexpr int window = max({Strategies::window...});
+    static constexpr size_t count = sizeof...(Strategies);
+    using Signals = array<Signal, sizeof...(Strategies)>;
 
-    cout << "Total Buy Value: $" << totalBuyValue << endl;
+    static array<const char*, sizeof...(Strategies)> names() { return {Strategies::name()...}; }
+
+    static Signals evaluate(const vector<MarketDataLoader::MarketData>& data) {
+        tuple<Strategies...> states;
+        int size = data.size();
+        int depth = min(size, window);
+
+        for (int i = size - depth; i < size; ++i) {
+            const MarketDataLoader::MarketData& bar = data[i];
+            int age = size - 1 - i;
+            std::apply([&](auto&... strategy) { (feed(strategy, bar, age), ...); }, states);
+        }
+
+        Signals signals;
+        size_t index = 0;
+        std::apply([&](const auto&... strategy) {
+            ((signals[index++] = size < decay_t<decltype(strategy)>::window ? Signal::NO_DATA : strategy.signal(data.back())), ...);
+        }, states);
+        return signals;
+    }
+
+    static void evaluateAll(const unordered_map<string, vector<MarketDataLoader::MarketData>>& marketData, vector<pair<string, Signals>>& out) {
+        out.clear();
+        out.reserve(marketData.size());
+        for (const auto& entry : marketData) {
+            out.emplace_back(entry.first, evaluate(entry.second));
+        }
+    }
+
+private:
+    template<class Strategy>
+    static void feed(Strategy& strategy, const MarketDataLoader::MarketData& bar, int age) {
+        if (age < Strategy::window) strategy.accumulate(bar, age);
+    }
+};
+
+// Runs a static pipeline behind the TradingStrategy interface so it can be picked from the menu
+template<class Pipeline>
+class PipelineStrategy : public TradingStrategy {
+public:
+    void applyStrategy(const unordered_map<string, vector<MarketDataLoader::MarketData>>& marketData) override {
+        cout << "Applying Combined Strategy..." << endl;
+
+        auto names = Pipeline::names();
+        for (const auto& entry : marketData) {
+            typename Pipeline::Signals signals = Pipeline::evaluate(entry.second);
+            cout << entry.first << ":";
+            for (size_t i = 0; i < Pipeline::count; ++i) {
+                cout << (i == 0 ? " " : ", ") << names[i] << " " << signalName(signals[i]);
+            }
+            cout << endl;
+        }
+    }
+};
+
+// Same configuration as the menu's individual strategies
+using ProductionPipeline = StrategyPipeline<StaticMovingAverage<10>, StaticRSI<14, 30, 70>, StaticMeanReversion<10, 500>, StaticMomentum<10>>;
+
+
+// ---------------- Order lifecycle ----------------
+
+enum class Side { BUY, SELL };
+enum class TimeInForce { IOC, FOK, DAY, GTC };
+enum class OrderState { PENDING_TRIGGER, WORKING, PARTIALLY_FILLED, FILLED, CANCELLED, EXPIRED, REJECTED };
+
+const char* orderTypeName(OrderType type) {
+    switch (type) {
+        case OrderType::MARKET: return "Market";
+        case OrderType::LIMIT: return "Limit";
+        case OrderType::STOP: return "Stop";
+        case OrderType::STOP_LIMIT: return "Stop Limit";
+        default: return "Trailing Stop";
+    }
+}
+
+const char* timeInForceName(TimeInForce timeInForce) {
+    switch (timeInForce) {
+        case TimeInForce::IOC: return "IOC";
+        case TimeInForce::FOK: return "FOK";
+        case TimeInForce::DAY: return "DAY";
+        default: return "GTC";
+    }
+}
+
+const char* orderStateName(OrderState state) {
+    switch (state) {
+        case OrderState::PENDING_TRIGGER: return "Pending Trigger";
+        case OrderState::WORKING: return "Working";
+        case OrderState::PARTIALLY_FILLED: return "Partially Filled";
+        case OrderState::FILLED: return "Filled";
+        case OrderState::CANCELLED: return "Cancelled";
+        case OrderState::EXPIRED: return "Expired";
+        default: return "Rejected";
+    }
+}
+
+struct OrderRequest {
+    string symbol;
+    Side side = Side::BUY;
+    OrderType type = OrderType::MARKET;
+    TimeInForce timeInForce = TimeInForce::DAY;
+    int quantity = 0;
+    double limitPrice = 0.0;   // LIMIT and STOP_LIMIT
+    double stopPrice = 0.0;    // STOP and STOP_LIMIT
+    double trailAmount = 0.0;  // TRAILING_STOP, distance in dollars from the best price seen
+};
+
+// Orders waiting for the price to reach a level, kept sorted by level.
+// A falling index fires orders when price <= level, a rising one when price >= level;
+// either way the crossed orders sit at the front, so firing k of n orders is O(log n + k).
+class PriceTriggerIndex {
+public:
+    using Handle = multimap<double, long long>::iterator;
+
+    PriceTriggerIndex(bool firesOnFall) : falling(firesOnFall) {}
+
+    Handle add(double level, long long id) { return levels.emplace(falling ? -level : level, id); }
+
+    void remove(Handle handle) { levels.erase(handle); }
+
+    // Removes every order crossed by price and appends its id to fired
+    void collect(double price, vector<long long>& fired) {
+        auto end = levels.upper_bound(falling ? -price : price);
+        for (auto it = levels.begin(); it != end; ++it) {
+            fired.push_back(it->second);
+        }
+        levels.erase(levels.begin(), end);
+    }
+
+    size_t size() const { return levels.size(); }
+
+private:
+    bool falling;
+    multimap<double, long long> levels;  // level, negated for falling indexes
+};
+
+// Trailing stops for one side of one symbol. Prices are mapped to x = price (sells) or
+// x = -price (buys) so both sides trail a high-water mark and fire when x <= highWater - trail.
+//
+// Orders placed at the same time share a high-water mark, and later placements always have a
+// lower or equal mark, so the marks form a stack. A new high only lifts (and merges) the groups
+// at the top of the stack. Groups are indexed by their highest stop level, so a price update
+// touches only groups that actually fire. Cancelled orders are dropped lazily when they fire.
+class TrailingStopIndex {
+public:
+    TrailingStopIndex(bool sellSide) : sign(sellSide ? 1.0 : -1.0) {}
+
+    void add(long long id, double trail, double price) {
+        double x = sign * price;
+        raise(x);
+        if (stack.empty() || groups[stack.back()].highWater != x) {
+            int g = nextGroup++;
+            groups[g].highWater = x;
+            groups[g].level = levels.end();
+            stack.push_back(g);
+        }
+        Group& group = groups[stack.back()];
+        group.byTrail.emplace(trail, id);
+        updateLevel(stack.back());
+        ++count;
+    }
+
+    void collect(double price, vector<long long>& fired) {
+        double x = sign * price;
+        raise(x);
+        while (!levels.empty() && prev(levels.end())->first >= x) {
+            int g = prev(levels.end())->second;
+            Group& group = groups[g];
+            auto it = group.byTrail.begin();
+            while (it != group.byTrail.end() && group.highWater - it->first >= x) {
+                fired.push_back(it->second);
+                it = group.byTrail.erase(it);
+                --count;
+            }
+            updateLevel(g);
+        }
+    }
+
+    size_t size() const { return count; }
+
+private:
+    struct Group {
+        double highWater;
+        multimap<double, long long> byTrail;     // trail amount, order id
+        multimap<double, int>::iterator level;   // entry in levels, or levels.end()
+    };
+
+    double sign;
+    unordered_map<int, Group> groups;
+    vector<int> stack;             // group ids, high-water marks non-increasing towards the top
+    multimap<double, int> levels;  // highest stop level (highWater - smallest trail), group id
+    int nextGroup = 0;
+    size_t count = 0;
+
+    // Every group whose high-water mark is below x now trails from x
+    void raise(double x) {
+        int merged = -1;
+        while (!stack.empty() && groups[stack.back()].highWater <= x) {
+            int g = stack.back();
+            stack.pop_back();
+            merged = merged < 0 ? g : merge(merged, g);
+        }
+        if (merged >= 0) {
+            groups[merged].highWater = x;
+            updateLevel(merged);
+            stack.push_back(merged);
+        }
+    }
+
+    // Moves the smaller group into the larger one and returns the survivor
+    int merge(int a, int b) {
+        if (groups[a].byTrail.size() < groups[b].byTrail.size()) swap(a, b);
+        Group& from = groups[b];
+        groups[a].byTrail.insert(from.byTrail.begin(), from.byTrail.end());
+        if (from.level != levels.end()) levels.erase(from.level);
+        groups.erase(b);
+        return a;
+    }
+
+    void updateLevel(int g) {
+        Group& group = groups[g];
+        if (group.level != levels.end()) levels.erase(group.level);
+        group.level = group.byTrail.empty() ? levels.end() : levels.emplace(group.highWater - group.byTrail.begin()->first, g);
+    }
+};
+
+struct ManagedOrder {
+    long long id;
+    OrderRequest request;
+    OrderState state = OrderState::WORKING;
+    int filledQuantity = 0;
+    double averagePrice = 0.0;
+
+    // Where the order is resting, so it can be cancelled (not used for trailing stops)
+    PriceTriggerIndex* index = nullptr;
+    PriceTriggerIndex::Handle handle;
+
+    bool isOpen() const {
+        return state == OrderState::PENDING_TRIGGER || state == OrderState::WORKING || state == OrderState::PARTIALLY_FILLED;
+    }
+};
+
+// Drives orders through their lifecycle against the portfolio:
+//   stops/trailing stops wait in PENDING_TRIGGER until the price crosses them, then act as a
+//   market (STOP, TRAILING_STOP) or limit (STOP_LIMIT) order;
+//   IOC fills what it can and cancels the rest, FOK fills completely or not at all;
+//   unfilled DAY/GTC limit orders rest until the price reaches them, DAY ones expire at endOfDay().
+// Market orders have no book to rest on, so any quantity the portfolio can't cover is cancelled.
+// Only open orders are kept; callers see an order's outcome in the snapshot submit() returns.
+class OrderManager {
+public:
+    OrderManager(Portfolio& pf) : portfolio(pf) {}
+
+    // Submits at the last price seen by onPrice, or at referencePrice if the symbol has had no
+    // price update. Returns the order as it stands after submission; check its state for the outcome.
+    ManagedOrder submit(const OrderRequest& request, double referencePrice) {
+        ManagedOrder order;
+        order.id = nextId++;
+        order.request = request;
+        double currentPrice = lastPrice(request.symbol, referencePrice);
+
+        if (!isValid(request) || !(currentPrice > 0.0)) {
+            order.state = OrderState::REJECTED;
+            cout << "Order " << order.id << " rejected." << endl;
+            return order;
+        }
+
+        SymbolBook& book = books.try_emplace(request.symbol).first->second;
+        bool buy = request.side == Side::BUY;
+        if (request.type == OrderType::STOP || request.type == OrderType::STOP_LIMIT) {
+            bool crossed = buy ? currentPrice >= request.stopPrice : currentPrice <= request.stopPrice;
+            if (!crossed) {
+                order.state = OrderState::PENDING_TRIGGER;
+                order.index = buy ? &book.buyStops : &book.sellStops;
+                order.handle = order.index->add(request.stopPrice, order.id);
+            }
+        } else if (request.type == OrderType::TRAILING_STOP) {
+            order.state = OrderState::PENDING_TRIGGER;
+            (buy ? book.trailingBuys : book.trailingSells).add(order.id, request.trailAmount, currentPrice);
+        }
+
+        if (order.state != OrderState::PENDING_TRIGGER) activate(order, currentPrice);
+        if (order.isOpen()) openOrders.emplace(order.id, order);
+        return order;
+    }
+
+    // Feed a new price for a symbol: fires the stops it crossed and retries the limits it reached
+    void onPrice(const string& symbol, double price) {
+        if (!(price > 0.0)) return;
+        lastPrices[symbol] = price;
+        auto it = books.find(symbol);
+        if (it == books.end()) return;
+        SymbolBook& book = it->second;
+
+        fired.clear();
+        book.buyLimits.collect(price, fired);
+        book.sellLimits.collect(price, fired);
+        for (long long id : fired) {
+            auto order = openOrders.find(id);
+            order->second.index = nullptr;
+            activate(order->second, price);
+            if (!order->second.isOpen()) openOrders.erase(order);
+        }
+
+        fired.clear();
+        book.buyStops.collect(price, fired);
+        book.sellStops.collect(price, fired);
+        book.trailingBuys.collect(price, fired);
+        book.trailingSells.collect(price, fired);
+        for (long long id : fired) {
+            auto order = openOrders.find(id);
+            if (order == openOrders.end()) continue;  // cancelled trailing stop
+            order->second.index = nullptr;
+            ++triggeredCount;
+            activate(order->second, price);
+            if (!order->second.isOpen()) openOrders.erase(order);
+        }
+    }
+
+    // Last price from onPrice, or fallback if there has been none for the symbol
+    double lastPrice(const string& symbol, double fallback) const {
+        auto it = lastPrices.find(symbol);
+        return it == lastPrices.end() ? fallback : it->second;
+    }
+
+    // Cancel an open order; cancelled receives its final (CANCELLED) state. False if id is not open
+    bool cancel(long long id, ManagedOrder& cancelled) {
+        auto it = openOrders.find(id);
+        if (it == openOrders.end()) return false;
+        unindex(it->second);
+        it->second.state = OrderState::CANCELLED;
+        cancelled = it->second;
+        openOrders.erase(it);
+        return true;
+    }
+
+    // Expire every open DAY order, returns their final (EXPIRED) states in id order
+    vector<ManagedOrder> endOfDay() {
+        vector<ManagedOrder> expired;
+        for (auto it = openOrders.begin(); it != openOrders.end();) {
+            if (it->second.request.timeInForce == TimeInForce::DAY) {
+                unindex(it->second);
+                it->second.state = OrderState::EXPIRED;
+                expired.push_back(it->second);
+                it = openOrders.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        sort(expired.begin(), expired.end(), [](const ManagedOrder& a, const ManagedOrder& b) { return a.id < b.id; });
+        return expired;
+    }
+
+    // Open orders in id order
+    vector<const ManagedOrder*> getOpenOrders() const {
+        vector<const ManagedOrder*> open;
+        for (const auto& entry : openOrders) open.push_back(&entry.second);
+        sort(open.begin(), open.end(), [](const ManagedOrder* a, const ManagedOrder* b) { return a->id < b->id; });
+        return open;
+    }
+
+    long long getTriggeredCount() const { return triggeredCount; }
+
+private:
+    struct SymbolBook {
+        PriceTriggerIndex buyStops{false}, sellStops{true};    // fire on a rise / fall to the stop
+        PriceTriggerIndex buyLimits{true}, sellLimits{false};  // resting limits, reached on a fall / rise
+        TrailingStopIndex trailingBuys{false}, trailingSells{true};
+    };
+
+    Portfolio& portfolio;
+    unordered_map<long long, ManagedOrder> openOrders;
+    unordered_map<string, SymbolBook> books;
+    unordered_map<string, double> lastPrices;
+    vector<long long> fired;  // scratch for onPrice
+    long long nextId = 1;
+    long long triggeredCount = 0;
+
+    static bool isValid(const OrderRequest& request) {
+        if (request.symbol.empty() || request.quantity <= 0) return false;
+        switch (request.type) {
+            case OrderType::LIMIT: return request.limitPrice > 0.0;
+            case OrderType::STOP: return request.stopPrice > 0.0;
+            case OrderType::STOP_LIMIT: return request.stopPrice > 0.0 && request.limitPrice > 0.0;
+            case OrderType::TRAILING_STOP: return request.trailAmount > 0.0;
+            default: return true;
+        }
+    }
+
+    // Trailing stops are not unindexed; their ids are skipped once they fire
+    static void unindex(ManagedOrder& order) {
+        if (order.index != nullptr) {
+            order.index->remove(order.handle);
+            order.index = nullptr;
+        }
+    }
+
+    // How much of the order the portfolio can cover at this price
+    int available(const ManagedOrder& order, double price) const {
+        if (order.request.side == Side::BUY) {
+            return (int)min<double>(INT_MAX, floor(portfolio.getCashBalance() / price));
+        }
+        const auto& stocks = portfolio.getStocks();
+        auto it = stocks.find(order.request.symbol);
+        return it == stocks.end() ? 0 : it->second.getQuantity();
+    }
+
+    // Try to execute an active (untriggered or triggered) order at price according to its time in force
+    void activate(ManagedOrder& order, double price) {
+        const OrderRequest& request = order.request;
+        bool isLimit = request.type == OrderType::LIMIT || request.type == OrderType::STOP_LIMIT;
+        bool marketable = !isLimit || (request.side == Side::BUY ? price <= request.limitPrice : price >= request.limitPrice);
+        int remaining = request.quantity - order.filledQuantity;
+        int fill = marketable ? min(remaining, available(order, price)) : 0;
+
+        if (request.timeInForce == TimeInForce::FOK && fill < remaining) {
+            order.state = OrderState::CANCELLED;
+            return;
+        }
+        if (fill > 0 && executeFill(order, fill, price)) {
+            remaining -= fill;
+        }
+
+        if (remaining == 0) {
+            order.state = OrderState::FILLED;
+        } else if (request.timeInForce == TimeInForce::IOC || !isLimit) {
+            order.state = OrderState::CANCELLED;
+        } else {
+            // Rest until the price reaches the limit again
+            order.state = order.filledQuantity > 0 ? OrderState::PARTIALLY_FILLED : OrderState::WORKING;
+            SymbolBook& book = books[request.symbol];
+            order.index = request.side == Side::BUY ? &book.buyLimits : &book.sellLimits;
+            order.handle = order.index->add(request.limitPrice, order.id);
+        }
+    }
+
+    // Logged as "<type> Order" for buys and "<type> Sell" for sells, as the original order paths did
+    bool executeFill(ManagedOrder& order, int quantity, double price) {
+        const OrderRequest& request = order.request;
+        bool buy = request.side == Side::BUY;
+        bool done = buy ? portfolio.buyStock(request.symbol, quantity, price)
+                        : portfolio.sellStock(request.symbol, quantity, price);
+        if (!done) return false;
+
+        logTransaction(string(orderTypeName(request.type)) + (buy ? " Order" : " Sell"), request.symbol, quantity, price,
+                       buy ? "BUY" : "SELL");
+        order.averagePrice = (order.averagePrice * order.filledQuantity + price * quantity) / (order.filledQuantity + quantity);
+        order.filledQuantity += quantity;
+        return true;
+    }
+};
+
+class TradeEngine {
+    MarketDataLoader& loader;
+    Portfolio& portfolio;
+    OrderManager orderManager;
+
+public:
+    TradeEngine(MarketDataLoader& ld, Portfolio& pf) : loader(ld), portfolio(pf), orderManager(pf) {}
+
+    // Market or limit buy; returns true if the order filled completely (see placeOrder)
+    bool executeOrder(Order* order, double currentPrice) {
+        double limitPrice = dynamic_cast<LimitOrder*>(order) != nullptr ? order->getPrice() : 0.0;
+        ManagedOrder result = placeOrder(order->getSymbol(), Side::BUY, order->getQuantity(), limitPrice, currentPrice);
+        if (!reportSimple(result)) return false;
+        order->execute(result.averagePrice);
+        return true;
+    }
+
+    void executeStrategy(TradingStrategy* strategy, const unordered_map<string, vector<MarketDataLoader::MarketData>>& marketData) {
+        PROFILE_SCOPE(Probe::APPLY_STRATEGY);
+        strategy->applyStrategy(marketData);
+    }
+
+    // Returns true if the shares were sold
+    bool MarketSell(const string& symbol, int quantity, double currentPrice) {
+        return reportSimple(placeOrder(symbol, Side::SELL, quantity, 0.0, currentPrice));
+    }
+
+    // Returns true if the shares were sold; otherwise the order rests until the price reaches limitPrice
+    bool LimitSell(const string& symbol, int quantity, double limitPrice, double currentPrice) {
+        ManagedOrder result = placeOrder(symbol, Side::SELL, quantity, limitPrice, currentPrice);
+        if (!reportSimple(result)) return false;
+        cout << "Executed Limit Sell Order for " << quantity << " shares of " << symbol
+             << " at $" << result.averagePrice << endl;
+        return true;
+    }
+
+    // Market (limitPrice 0) or limit order as the menu, batch mode and the order server place them.
+    // Like every order they go through OrderManager: market orders are all-or-nothing (FOK), and
+    // limit orders use limitTimeInForce. The menu rests them as DAY orders; batch mode and the server
+    // pass IOC since nothing there ever updates the price, cancels or ends the day.
+    ManagedOrder placeOrder(const string& symbol, Side side, int quantity, double limitPrice, double currentPrice,
+                            TimeInForce limitTimeInForce = TimeInForce::DAY) {
+        PROFILE_SCOPE(side == Side::BUY ? Probe::EXECUTE_ORDER : limitPrice > 0.0 ? Probe::LIMIT_SELL : Probe::MARKET_SELL);
+        OrderRequest request;
+        request.symbol = symbol;
+        request.side = side;
+        request.quantity = quantity;
+        if (limitPrice > 0.0) {
+            request.type = OrderType::LIMIT;
+            request.timeInForce = limitTimeInForce;
+            request.limitPrice = limitPrice;
+        } else {
+            request.type = OrderType::MARKET;
+            request.timeInForce = TimeInForce::FOK;
+        }
+        return orderManager.submit(request, currentPrice);
+    }
+
+    // Stop, stop-limit, trailing stop and time-in-force orders; see OrderManager
+    ManagedOrder submitOrder(const OrderRequest& request, double currentPrice) {
+        PROFILE_SCOPE(Probe::SUBMIT_ORDER);
+        return orderManager.submit(request, currentPrice);
+    }
+
+    void onPriceUpdate(const string& symbol, double price) {
+        PROFILE_SCOPE(Probe::PRICE_UPDATE);
+        orderManager.onPrice(symbol, price);
+    }
+
+    // The price orders for symbol execute against: the last price update, else closePrice
+    double currentPrice(const string& symbol, double closePrice) const {
+        return orderManager.lastPrice(symbol, closePrice);
+    }
+
+    bool cancelOrder(long long id, ManagedOrder& cancelled) { return orderManager.cancel(id, cancelled); }
+
+    vector<ManagedOrder> endOfDay() { return orderManager.endOfDay(); }
+
+    const OrderManager& getOrderManager() const { return orderManager; }
+
+private:
+    // Says why an order did not fill completely; true if it did
+    static bool reportSimple(const ManagedOrder& order) {
+        const OrderRequest& request = order.request;
+        bool buy = request.side == Side::BUY;
+        if (order.state == OrderState::FILLED) return true;
+        if (order.isOpen()) {
+            cout << (buy ? "Limit Order #" : "Limit Sell Order #") << order.id << ": "
+                 << request.quantity - order.filledQuantity << " shares of " << request.symbol
+                 << " resting at $" << request.limitPrice << " until the price reaches it." << endl;
+        } else if (order.state == OrderState::CANCELLED) {
+            cout << "Order for " << request.quantity << " shares of " << request.symbol << " not executed: "
+                 << (buy ? "insufficient cash." : "not enough shares.") << endl;
+        }
+        return false;
+    }
+};
+
+
+// User interaction with the system
+void displayMenu() {
+    cout << "\n---- AutoTrader++ ----\n";
+    cout << "1. View Portfolio\n";
+    // cout << "2. View Latest Price of a Stock\n";
+    cout << "2. View Current Market\n";
+    cout << "3. Place a Market Order\n";
+    cout << "4. Place a Limit Order\n";
+    cout << "5. Execute a Trading Strategy\n";
+    cout << "6. Sell a Market Order\n";
+    cout << "7. Sell a Limit Order\n";
+    cout << "8. Exit\n";
+    cout << "9. View Price History\n";
+    cout << "10. View Market on a Date\n";
+    cout << "11. View Latency Statistics\n";
+    cout << "12. Place a Stop / Stop-Limit / Trailing Stop / IOC / FOK Order\n";
+    cout << "13. View or Cancel Open Orders\n";
+    cout << "14. Enter a Price Update\n";
+    cout << "15. End the Trading Day\n";
+    cout << "Enter your choice: ";
+}
+
+// *********************************************
+void parseLogLine(const string& logLine, string& transactionType, string& orderType, string& symbol, int& quantity, double& price, double& totalValue) {
+    stringstream ss(logLine);
+    string token;
+
+    getline(ss, transactionType, ',');
+    getline(ss, orderType, ',');
+    getline(ss, symbol, ',');
+    
+    getline(ss, token, ',');
+    quantity = stoi(token);
+    
+    getline(ss, token, ',');
+    price = stod(token);
+    
+    getline(ss, token, ',');
+    totalValue = stod(token);
+}
+
+
+void calculateTotalBuySell() {
+    ifstream logFile("log.txt");
+    if (!logFile.is_open()) {
+        cout << "Error: Could not open transaction log file." << endl;
+        return;
+    }
+
+    string logLine;
+    double totalBuyValue = 0.0;
+    double totalSellValue = 0.0;
+
+    while (getline(logFile, logLine)) {
+        string transactionType, orderType, symbol;
+        int quantity;
+        double price, totalValue;
+
+        parseLogLine(logLine, transactionType, orderType, symbol, quantity, price, totalValue);
+
+        if (transactionType == "BUY") {
+            totalBuyValue += totalValue;
+        } else if (transactionType == "SELL") {
+            totalSellValue += totalValue;
+        }
+    }
+
+    logFile.close();
+
+    cout << "Total Buy Value: $" << totalBuyValue << endl;
     cout << "Total Sell Value: $" << totalSellValue << endl;
     cout<< "Total Buy-Sell Value: $" << totalBuyValue - totalSellValue << endl;
 }
 
-void calculateTotalProfitLoss() {
-    vector<string> companies = {"AAPL", "GOOG", "AMZN", "TSLA", "MSFT","BABA","DIS","META","NFLX","NVDA"};
-    MarketDataLoader loader;
-    unordered_map<string, vector<MarketDataLoader::MarketData>> marketData = loader.loadMarketData(companies);
+void calculateTotalProfitLoss() {
+    vector<string> companies = {"AAPL", "GOOG", "AMZN", "TSLA", "MSFT","BABA","DIS","META","NFLX","NVDA"};
+    MarketDataLoader loader;
+    unordered_map<string, vector<MarketDataLoader::MarketData>> marketData = loader.loadMarketData(companies);
+
+    ifstream logFile("log.txt");
+    if (!logFile.is_open()) {
+        cout << "Error: Could not open transaction log file." << endl;
+        return;
+    }
+
+    string logLine;
+    double totalProfit = 0.0;
+    double totalLoss = 0.0;
+
+    while (getline(logFile, logLine)) {
+        string transactionType, orderType, symbol;
+        int quantity;
+        double price, totalValue;
+
+        parseLogLine(logLine, transactionType, orderType, symbol, quantity, price, totalValue);
+
+        if (transactionType == "SELL") {
+            double currentPrice = loader.getLatestPrice(symbol,marketData);
+            double profitLoss = totalValue - quantity * currentPrice;
+            if (profitLoss > 0) {
+                totalProfit += profitLoss;
+            } else {
+                totalLoss += profitLoss;
+            }
+        }
+    }
+
+    logFile.close();
+
+    cout << "Total Profit: $" << totalProfit << endl;
+    cout << "Total Loss: $" << totalLoss << endl;
+}
+
+// *****************************************************************************
+
+// Stream buffer that discards everything, used to silence console output
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    streamsize xsputn(const char*, streamsize n) override { return n; }
+};
+
+// ---------------- Benchmark suite ----------------
+
+// Deterministic generator for synthetic market data and order streams.
+// Uses its own PRNG (splitmix64) so the same seed gives the same files with any standard library.
+class SyntheticMarket {
+public:
+    struct SyntheticOrder {
+        OrderType type;
+        bool isBuy;
+        string symbol;
+        int quantity;
+        double limitPrice;  // unused for market orders
+    };
+
+    SyntheticMarket(uint64_t seed) : state(seed) {}
+
+    static string symbolName(int index) {
+        char buffer[16];
+        snprintf(buffer, sizeof(buffer), "SYN%04d", index);
+        return buffer;
+    }
+
+    // Random walk bars with the indicator columns filled in (see BarAggregator::computeIndicators)
+    vector<MarketDataLoader::MarketData> bars(int count) {
+        vector<MarketDataLoader::MarketData> data(count);
+        double price = 50.0 + 150.0 * uniform();
+        int startDay = parseDate("2000-01-03");
+
+        for (int i = 0; i < count; ++i) {
+            MarketDataLoader::MarketData& bar = data[i];
+            bar.day = startDay + i;
+            bar.date = formatDate(bar.day);
+            bar.openPrice = round2(price);
+            price = max(1.0, price * (1.0 + 0.04 * (uniform() - 0.5)));
+            bar.closePrice = round2(price);
+            bar.highPrice = round2(max(bar.openPrice, bar.closePrice) * (1.0 + 0.02 * uniform()));
+            bar.lowPrice = round2(min(bar.openPrice, bar.closePrice) * (1.0 - 0.02 * uniform()));
+            bar.volume = floor(1000000 + 4000000 * uniform());
+        }
+        BarAggregator::computeIndicators(data);
+        return data;
+    }
+
+    // Random walk trades one to ten seconds apart, starting at startTimestamp
+    vector<BarAggregator::Tick> ticks(int count, long long startTimestamp) {
+        vector<BarAggregator::Tick> data(count);
+        double price = 50.0 + 150.0 * uniform();
+        long long timestamp = startTimestamp;
+        for (auto& tick : data) {
+            timestamp += 1 + (long long)(next() % 10);
+            price = max(1.0, price * (1.0 + 0.002 * (uniform() - 0.5)));
+            tick.timestamp = timestamp;
+            tick.price = round2(price);
+            tick.volume = (double)(100 * (1 + next() % 50));
+        }
+        return data;
+    }
+
+    // Writes bars in the exact schema loadCompanyData expects
+    static bool writeCsv(const string& filename, const vector<MarketDataLoader::MarketData>& data) {
+        ofstream file(filename);
+        if (!file.is_open()) {
+            cout << "Error: Could not create file " << filename << endl;
+            return false;
+        }
+        file << "date,openPrice,highPrice,lowPrice,closePrice,volume,gain,loss,avgGain,avgLoss,rsi,movingAvg,momentum,upperThreshold,lowerThreshold\n";
+        file << fixed << setprecision(2);
+        for (const auto& bar : data) {
+            file << bar.date << "," << bar.openPrice << "," << bar.highPrice << "," << bar.lowPrice << ","
+                 << bar.closePrice << "," << (long long)bar.volume << "," << bar.gain << "," << bar.loss << ","
+                 << bar.avgGain << "," << bar.avgLoss << "," << bar.rsi << "," << bar.movingAvg << ","
+                 << bar.momentum << "," << bar.upperThreshold << "," << bar.lowerThreshold << "\n";
+        }
+        return true;
+    }
+
+    // Mix of market/limit buys and sells, limit prices within 5% of the symbol's last close
+    vector<SyntheticOrder> orders(int count, const vector<string>& symbols, const unordered_map<string, vector<MarketDataLoader::MarketData>>& marketData) {
+        vector<SyntheticOrder> stream;
+        stream.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            SyntheticOrder order;
+            order.symbol = symbols[next() % symbols.size()];
+            order.type = next() % 2 == 0 ? OrderType::MARKET : OrderType::LIMIT;
+            order.isBuy = next() % 3 != 0;
+            order.quantity = 1 + (int)(next() % 100);
+            double lastClose = marketData.at(order.symbol).back().closePrice;
+            order.limitPrice = round2(lastClose * (0.95 + 0.10 * uniform()));
+            stream.push_back(order);
+        }
+        return stream;
+    }
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    double uniform() { return (next() >> 11) * 0x1.0p-53; }
+
+private:
+    uint64_t state;
+
+    static double round2(double value) { return round(value * 100.0) / 100.0; }
+};
+
+class BenchmarkSuite {
+public:
+    struct Result {
+        string name;
+        long long operations;
+        double seconds;
+    };
+
+    // Times fn, which performs `operations` units of work per call, over `iterations` calls
+    template<class Fn>
+    void run(const string& name, long long operations, int iterations, Fn fn) {
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            fn();
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        results.push_back({name, operations * iterations, seconds});
+    }
+
+    string toJson(const vector<pair<string, long long>>& config) const {
+        stringstream json;
+        json << fixed << setprecision(3);
+        json << "{\n  \"config\": {";
+        for (size_t i = 0; i < config.size(); ++i) {
+            json << (i == 0 ? "" : ", ") << "\"" << config[i].first << "\": " << config[i].second;
+        }
+        json << "},\n  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            json << "    {\"name\": \"" << r.name << "\", \"operations\": " << r.operations
+                 << ", \"total_ms\": " << r.seconds * 1e3
+                 << ", \"ns_per_op\": " << (r.operations ? r.seconds * 1e9 / r.operations : 0.0)
+                 << ", \"ops_per_sec\": " << (r.seconds > 0 ? r.operations / r.seconds : 0.0) << "}"
+                 << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        json << "  ]\n}";
+        return json.str();
+    }
+
+private:
+    vector<Result> results;
+};
+
+// Runs every scenario on generated data inside a scratch directory so the real
+// portfolio.txt and log.txt are never touched.
+// Usage: main --bench [--symbols N] [--bars M] [--ticks T] [--orders K] [--stops R] [--iterations I] [--seed S] [--dir path] [--out file.json]
+int runBenchmarks(int argc, char* argv[]) {
+    long long symbolCount = 100, barCount = 1000, tickCount = 1000000, orderCount = 2000, stopCount = 1000000, iterations = 20, seed = 42;
+    string directory = "bench_data";
+    string outFile;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        string flag = argv[i];
+        if (flag == "--symbols") symbolCount = atoll(argv[i + 1]);
+        else if (flag == "--bars") barCount = atoll(argv[i + 1]);
+        else if (flag == "--ticks") tickCount = atoll(argv[i + 1]);
+        else if (flag == "--orders") orderCount = atoll(argv[i + 1]);
+        else if (flag == "--stops") stopCount = atoll(argv[i + 1]);
+        else if (flag == "--iterations") iterations = atoll(argv[i + 1]);
+        else if (flag == "--seed") seed = atoll(argv[i + 1]);
+        else if (flag == "--dir") directory = argv[i + 1];
+        else if (flag == "--out") outFile = argv[i + 1];
+        else {
+            cout << "Unknown benchmark option: " << flag << endl;
+            return 1;
+        }
+    }
+    if (symbolCount <= 0 || barCount <= 0 || tickCount < 0 || orderCount < 0 || stopCount < 0 || iterations <= 0) {
+        cout << "Benchmark sizes must be positive." << endl;
+        return 1;
+    }
+
+    filesystem::path originalDirectory = filesystem::current_path();
+    filesystem::create_directories(directory);
+    filesystem::current_path(directory);
+
+    // Generate the data set
+    SyntheticMarket generator(seed);
+    vector<string> symbols;
+    for (int s = 0; s < symbolCount; ++s) {
+        symbols.push_back(SyntheticMarket::symbolName(s));
+        if (!SyntheticMarket::writeCsv(symbols.back() + ".csv", generator.bars(barCount))) {
+            filesystem::current_path(originalDirectory);
+            return 1;
+        }
+    }
+
+    // Everything below reports through cout, so send it nowhere while timing
+    NullBuffer nullBuffer;
+    streambuf* consoleBuffer = cout.rdbuf(&nullBuffer);
+    BenchmarkSuite suite;
+    MarketDataLoader loader;
+    unordered_map<string, vector<MarketDataLoader::MarketData>> marketData;
+
+    suite.run("csv_ingest", symbolCount * barCount, 1, [&]() {
+        marketData = loader.loadMarketData(symbols);
+    });
+
+    MovingAverageStrategy maStrategy(10);
+    RSIStrategy rsiStrategy(14, 30.0, 70.0);
+    MeanReversionStrategy mrStrategy(10, 0.05);
+    MomentumStrategy momentumStrategy(10);
+    PipelineStrategy<ProductionPipeline> combinedStrategy;
+    vector<pair<string, ProductionPipeline::Signals>> signals;
+
+    suite.run("strategy_moving_average", symbolCount, iterations, [&]() { maStrategy.applyStrategy(marketData); });
+    suite.run("strategy_rsi", symbolCount, iterations, [&]() { rsiStrategy.applyStrategy(marketData); });
+    suite.run("strategy_mean_reversion", symbolCount, iterations, [&]() { mrStrategy.applyStrategy(marketData); });
+    suite.run("strategy_momentum", symbolCount, iterations, [&]() { momentumStrategy.applyStrategy(marketData); });
+    suite.run("strategy_all_virtual_sequential", symbolCount, iterations, [&]() {
+        maStrategy.applyStrategy(marketData);
+        rsiStrategy.applyStrategy(marketData);
+        mrStrategy.applyStrategy(marketData);
+        momentumStrategy.applyStrategy(marketData);
+    });
+    suite.run("strategy_all_fused_pipeline", symbolCount, iterations, [&]() { combinedStrategy.applyStrategy(marketData); });
+    suite.run("strategy_all_fused_signals_only", symbolCount, iterations, [&]() { ProductionPipeline::evaluateAll(marketData, signals); });
+
+    // Bar aggregation: daily bars rolled up, and one-minute and volume bars built from raw ticks
+    unordered_map<string, vector<MarketDataLoader::MarketData>> resampled;
+    suite.run("resample_weekly", symbolCount * barCount, iterations, [&]() { resampled = BarAggregator::resampleAll(marketData, Timeframe::WEEKLY); });
+    suite.run("resample_monthly", symbolCount * barCount, iterations, [&]() { resampled = BarAggregator::resampleAll(marketData, Timeframe::MONTHLY); });
+    SyntheticMarket tickGenerator(seed + 2);
+    vector<BarAggregator::Tick> ticks = tickGenerator.ticks((int)tickCount, 946857600);  // 2000-01-03
+    vector<MarketDataLoader::MarketData> tickBars;
+    suite.run("ticks_to_time_bars", tickCount, iterations, [&]() { BarAggregator::timeBars(ticks, 60, tickBars); });
+    suite.run("ticks_to_volume_bars", tickCount, iterations, [&]() { BarAggregator::volumeBars(ticks, 50000, tickBars); });
+
+    // Order execution against a fresh, well funded portfolio
+    remove("log.txt");
+    remove("log_buy.txt");
+    remove("log_sell.txt");
+    {
+        ofstream file("portfolio.txt");
+        file << 1e12 << endl;
+    }
+    vector<SyntheticMarket::SyntheticOrder> orders = generator.orders(orderCount, symbols, marketData);
+    Portfolio portfolio;
+    TradeEngine engine(loader, portfolio);
+    suite.run("order_execution", orderCount, 1, [&]() {
+        for (const auto& order : orders) {
+            double currentPrice = loader.getLatestPrice(order.symbol, marketData);
+            if (order.isBuy && order.type == OrderType::MARKET) {
+                MarketOrder marketOrder(order.symbol, order.quantity);
+                engine.executeOrder(&marketOrder, currentPrice);
+            } else if (order.isBuy) {
+                LimitOrder limitOrder(order.symbol, order.quantity, order.limitPrice);
+                engine.executeOrder(&limitOrder, currentPrice);
+            } else if (order.type == OrderType::MARKET) {
+                engine.MarketSell(order.symbol, order.quantity, currentPrice);
+            } else {
+                engine.LimitSell(order.symbol, order.quantity, order.limitPrice, currentPrice);
+            }
+        }
+    });
+
+    suite.run("portfolio_save", 1, iterations, [&]() { portfolio.savePortfolio(); });
+    suite.run("portfolio_load", 1, iterations, [&]() { portfolio.loadPortfolio(); });
+
+    // Log analytics over a log of orderCount * 10 transactions
+    {
+        ofstream logFile("log.txt");
+        for (long long i = 0; i < orderCount * 10; ++i) {
+            const auto& order = orders[i % orders.size()];
+            logFile << (order.isBuy ? "BUY" : "SELL") << ", " << (order.type == OrderType::MARKET ? "Market Order" : "Limit Order")
+                    << ", " << order.symbol << ", " << order.quantity << ", " << order.limitPrice << ", "
+                    << order.quantity * order.limitPrice << "\n";
+        }
+    }
+    suite.run("log_analytics", orderCount * 10, iterations, [&]() { calculateTotalBuySell(); });
+
+    // stopCount resting stops (one in ten trailing) within 20% of the price, then a random walk of
+    // price updates. Fills go to an in-memory log so the scenario measures the trigger indexes.
+    {
+        vector<LogRecord> records;
+        capturedLogs = &records;
+        Portfolio stopPortfolio;
+        stopPortfolio.setAutoSave(false);
+        TradeEngine stopEngine(loader, stopPortfolio);
+        vector<double> prices;
+        for (const auto& symbol : symbols) {
+            prices.push_back(loader.getLatestPrice(symbol, marketData));
+            stopPortfolio.buyStock(symbol, 1000000, prices.back());  // shares for the sell stops
+        }
+
+        SyntheticMarket stopGenerator(seed + 1);
+        vector<OrderRequest> requests(stopCount);
+        for (long long i = 0; i < stopCount; ++i) {
+            OrderRequest& request = requests[i];
+            double price = prices[i % symbolCount];
+            request.symbol = symbols[i % symbolCount];
+            request.side = (i / symbolCount) % 2 == 0 ? Side::BUY : Side::SELL;
+            request.timeInForce = TimeInForce::GTC;
+            request.quantity = 1;
+            double offset = price * 0.2 * stopGenerator.uniform();
+            if (i % 10 == 9) {
+                request.type = OrderType::TRAILING_STOP;
+                request.trailAmount = max(0.01, offset);
+            } else {
+                request.type = OrderType::STOP;
+                request.stopPrice = request.side == Side::BUY ? price + offset : max(0.01, price - offset);
+            }
+        }
+        suite.run("stop_orders_submit", stopCount, 1, [&]() {
+            for (long long i = 0; i < stopCount; ++i) {
+                stopEngine.submitOrder(requests[i], prices[i % symbolCount]);
+            }
+        });
+
+        // Each update moves one symbol by up to 0.5%
+        const long long updateCount = 100000;
+        vector<pair<int, double>> updates;
+        vector<double> walk = prices;
+        for (long long u = 0; u < updateCount; ++u) {
+            int s = (int)(stopGenerator.next() % symbolCount);
+            walk[s] *= 1.0 + (stopGenerator.uniform() - 0.5) * 0.01;
+            updates.push_back({s, walk[s]});
+        }
+        suite.run("stop_orders_price_update", updateCount, 1, [&]() {
+            for (const auto& update : updates) {
+                stopEngine.onPriceUpdate(symbols[update.first], update.second);
+                records.clear();
+            }
+        });
+
+        // Baseline: scanning the symbol's plain stops on every update instead of using the index
+        const long long scanCount = min<long long>(updateCount, 1000);
+        volatile long long crossedSink = 0;  // keeps the scan from being optimised away
+        suite.run("stop_orders_price_update_linear_scan", scanCount, 1, [&]() {
+            for (long long u = 0; u < scanCount; ++u) {
+                const auto& update = updates[u];
+                long long crossed = 0;
+                for (long long i = update.first; i < stopCount; i += symbolCount) {
+                    const OrderRequest& request = requests[i];
+                    if (request.type == OrderType::STOP &&
+                        (request.side == Side::BUY ? update.second >= request.stopPrice : update.second <= request.stopPrice)) {
+                        ++crossed;
+                    }
+                }
+                crossedSink = crossedSink + crossed;
+            }
+        });
+        capturedLogs = nullptr;
+    }
+
+    cout.rdbuf(consoleBuffer);
+    filesystem::current_path(originalDirectory);
+
+    string json = suite.toJson({{"seed", seed}, {"symbols", symbolCount}, {"bars", barCount}, {"ticks", tickCount}, {"orders", orderCount}, {"stops", stopCount}, {"iterations", iterations}});
+    cout << json << endl;
+    if (!outFile.empty()) {
+        ofstream file(outFile);
+        if (!file.is_open()) {
+            cout << "Error: Could not open " << outFile << " for writing." << endl;
+            return 1;
+        }
+        file << json << endl;
+    }
+    return 0;
+}
+
+// ---------------- Shared-memory publishing ----------------
+#ifdef __linux__
+
+// Publishes latest bars and positions into the shared-memory feed described in market_feed.h.
+// Must only be used from one thread at a time (the seqlocks allow a single writer).
+// The writer holds an exclusive flock on the region for as long as it publishes, so a second
+// process finds the feed taken and does not publish, while a region left by a crashed run is reused.
+class SharedMemoryPublisher {
+public:
+    ~SharedMemoryPublisher() {
+        if (region != nullptr) {
+            munmap(region, sizeof(feed::FeedRegion));
+            shm_unlink(feedName.c_str());  // still holding the lock, so this is our region
+            close(lockFd);
+        }
+    }
+
+    bool open(const string& name = feed::DEFAULT_FEED_NAME) {
+        int fd;
+        while (true) {
+            fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+            if (fd < 0) return false;
+            if (flock(fd, LOCK_EX | LOCK_NB) < 0) {
+                close(fd);
+                cout << "Market feed " << name << " is published by another process; not publishing." << endl;
+                return false;
+            }
+            // The previous owner may have unlinked the region just before releasing the lock
+            struct stat info;
+            if (fstat(fd, &info) == 0 && info.st_nlink > 0) break;
+            close(fd);
+        }
+        if (ftruncate(fd, sizeof(feed::FeedRegion)) < 0) {
+            close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, sizeof(feed::FeedRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        lockFd = fd;
+
+        // Start from a clean region even if a crashed run left one behind
+        region = static_cast<feed::FeedRegion*>(mapped);
+        region->magic.store(0, memory_order_relaxed);
+        memset((char*)region + sizeof(region->magic), 0, sizeof(feed::FeedRegion) - sizeof(region->magic));
+        region->version = feed::FEED_VERSION;
+        region->magic.store(feed::FEED_MAGIC, memory_order_release);
+        feedName = name;
+        return true;
+    }
+
+    bool isOpen() const { return region != nullptr; }
+
+    void publishBar(const string& symbol, const MarketDataLoader::MarketData& bar) {
+        if (region == nullptr) return;
+        int slot = slotFor(symbol);
+        if (slot < 0) return;
+        feed::BarSnapshot snapshot{};
+        copySymbol(snapshot.symbol, symbol);
+        snapshot.day = bar.day;
+        snapshot.open = bar.openPrice;
+        snapshot.high = bar.highPrice;
+        snapshot.low = bar.lowPrice;
+        snapshot.close = bar.closePrice;
+        snapshot.volume = bar.volume;
+        snapshot.rsi = bar.rsi;
+        snapshot.movingAvg = bar.movingAvg;
+        region->symbols[slot].bar.store(snapshot);
+    }
+
+    // Latest bar of every symbol
+    void publishBars(const unordered_map<string, vector<MarketDataLoader::MarketData>>& marketData) {
+        if (region == nullptr) return;
+        vector<string> symbols;
+        for (const auto& entry : marketData) symbols.push_back(entry.first);
+        sort(symbols.begin(), symbols.end());  // stable slot order between runs
+        for (const auto& symbol : symbols) {
+            const auto& data = marketData.at(symbol);
+            if (!data.empty()) publishBar(symbol, data.back());
+        }
+    }
+
+    // Position of every known symbol (zero when not held) plus the cash balance
+    void publishPositions(const Portfolio& portfolio) {
+        if (region == nullptr) return;
+        const unordered_map<string, Stock>& stocks = portfolio.getStocks();
+        for (const auto& entry : stocks) slotFor(entry.first);
+
+        for (size_t slot = 0; slot < slotSymbols.size(); ++slot) {
+            feed::PositionSnapshot snapshot{};
+            copySymbol(snapshot.symbol, slotSymbols[slot]);
+            auto it = stocks.find(slotSymbols[slot]);
+            if (it != stocks.end()) {
+                snapshot.quantity = it->second.getQuantity();
+                snapshot.purchasePrice = it->second.getPurchasePrice();
+            }
+            region->symbols[slot].position.store(snapshot);
+        }
+        region->account.store({portfolio.getCashBalance(), ++positionUpdates});
+    }
+
+private:
+    feed::FeedRegion* region = nullptr;
+    int lockFd = -1;  // kept open to hold the writer lock
+    string feedName;
+    unordered_map<string, int> slots;
+    vector<string> slotSymbols;
+    uint64_t positionUpdates = 0;
+
+    static void copySymbol(char* out, const string& symbol) {
+        memcpy(out, symbol.data(), min(symbol.size(), (size_t)feed::SYMBOL_LENGTH - 1));
+    }
+
+    // Symbols get a slot the first time they are published, -1 once the region is full
+    int slotFor(const string& symbol) {
+        auto it = slots.find(symbol);
+        if (it != slots.end()) return it->second;
+        int slot = (int)slotSymbols.size();
+        if (slot >= feed::MAX_SYMBOLS) return -1;
+
+        copySymbol(region->symbols[slot].symbol, symbol);
+        region->symbolCount.store(slot + 1, memory_order_release);  // name is visible before the count
+        slots[symbol] = slot;
+        slotSymbols.push_back(symbol);
+        return slot;
+    }
+};
+
+#else
+
+// POSIX shared memory is only wired up on Linux; elsewhere publishing does nothing
+class SharedMemoryPublisher {
+public:
+    bool open(const string& = "") { return false; }
+    bool isOpen() const { return false; }
+    void publishBar(const string&, const MarketDataLoader::MarketData&) {}
+    void publishBars(const unordered_map<string, vector<MarketDataLoader::MarketData>>&) {}
+    void publishPositions(const Portfolio&) {}
+};
+
+#endif
+
+// ---------------- Headless batch mode ----------------
+
+// Fixed size little-endian frame used by the binary command format
+#pragma pack(push, 1)
+struct OrderFrame {
+    uint8_t command;     // 1 = buy, 2 = sell, 3 = strategy
+    uint8_t orderType;   // 0 = market, 1 = limit
+    uint16_t strategy;   // strategy number as in the menu (strategy frames only)
+    char symbol[8];      // NUL padded
+    int32_t quantity;
+    double limitPrice;
+};
+#pragma pack(pop)
+static_assert(sizeof(OrderFrame) == 24, "OrderFrame must stay 24 bytes");
+
+struct BatchCommand {
+    enum Kind { BUY, SELL, STRATEGY } kind;
+    OrderType type = OrderType::MARKET;
+    string symbol;
+    int quantity = 0;
+    double limitPrice = 0.0;
+    int strategy = 0;
+    double currentPrice = 0.0;  // filled in by the risk stage
+};
+
+// Blocking queue with a fixed capacity between two pipeline stages
+template<class T>
+class BoundedQueue {
+    deque<T> items;
+    size_t capacity;
+    bool closed = false;
+    mutex m;
+    condition_variable notEmpty, notFull;
+
+public:
+    BoundedQueue(size_t cap) : capacity(cap) {}
+
+    void push(T item) {
+        unique_lock<mutex> lock(m);
+        notFull.wait(lock, [&] { return items.size() < capacity; });
+        items.push_back(move(item));
+        notEmpty.notify_one();
+    }
+
+    // Returns false once the queue is closed and drained
+    bool pop(T& item) {
+        unique_lock<mutex> lock(m);
+        notEmpty.wait(lock, [&] { return !items.empty() || closed; });
+        if (items.empty()) return false;
+        item = move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        lock_guard<mutex> lock(m);
+        closed = true;
+        notEmpty.notify_all();
+    }
+};
+
+// Writes captured log records, keeping each log file open between writes
+class LogJournal {
+    map<string, ofstream> files;
+
+public:
+    void write(const vector<LogRecord>& records) {
+        for (const auto& record : records) {
+            ofstream& file = files[record.filename];
+            if (!file.is_open()) file.open(record.filename, ios::app);
+            file << record.line << '\n';
+        }
+    }
+
+    void flush() {
+        for (auto& entry : files) entry.second.flush();
+    }
+};
+
+// Runs a stream of commands through parse -> risk -> execute -> journal stages, each on
+// its own thread, passing batches of commands through bounded queues.
+//
+// Text format, one command per line ('#' starts a comment):
+//   BUY <symbol> <quantity> [limit price]
+//   SELL <symbol> <quantity> [limit price]
+//   STRATEGY <1-5>            (same numbering as the menu)
+class BatchProcessor {
+public:
+    static constexpr size_t BATCH_SIZE = 1024;
+    static constexpr size_t QUEUE_DEPTH = 64;
+    static constexpr int MAX_ORDER_QUANTITY = 1000000;
+
+    struct Summary {
+        long long read = 0, parseErrors = 0, rejected = 0;
+        long long ordersFilled = 0, ordersNotFilled = 0, strategiesRun = 0;
+        long long logLines = 0;
+        double seconds = 0.0;
+    };
+
+    BatchProcessor(TradeEngine& eng, MarketDataLoader& ld, const unordered_map<string, vector<MarketDataLoader::MarketData>>& data)
+        : engine(eng), loader(ld), marketData(data) {}
+
+    // Publish positions to shared memory after every executed batch
+    void publishTo(SharedMemoryPublisher* pub, const Portfolio* pf) {
+        publisher = pub;
+        publishedPortfolio = pf;
+    }
+
+    Summary run(istream& input, bool binary) {
+        Summary summary;
+        BoundedQueue<vector<BatchCommand>> parsed(QUEUE_DEPTH), validated(QUEUE_DEPTH);
+        BoundedQueue<vector<LogRecord>> journal(QUEUE_DEPTH);
+
+        // Engine and strategies report through cout; only the summary should be printed.
+        // A failed stream skips formatting entirely, which is cheaper than writing to a null buffer.
+        streambuf* consoleBuffer = cout.rdbuf();
+        cout.setstate(ios::badbit);
+        auto start = chrono::steady_clock::now();
+
+        thread parseStage([&] {
+            if (binary) parseBinary(input, parsed, summary);
+            else parseText(input, parsed, summary);
+            parsed.close();
+        });
+
+        thread riskStage([&] {
+            vector<BatchCommand> batch;
+            while (parsed.pop(batch)) {
+                vector<BatchCommand> accepted;
+                accepted.reserve(batch.size());
+                for (auto& command : batch) {
+                    if (validateCommand(command, marketData)) accepted.push_back(move(command));
+                    else ++summary.rejected;
+                }
+                if (!accepted.empty()) validated.push(move(accepted));
+            }
+            validated.close();
+        });
+
+        thread executeStage([&] {
+            vector<BatchCommand> batch;
+            while (validated.pop(batch)) {
+                vector<LogRecord> records;
+                capturedLogs = &records;
+                for (const auto& command : batch) {
+                    execute(command, records, consoleBuffer, summary);
+                }
+                capturedLogs = nullptr;
+                if (publisher != nullptr) publisher->publishPositions(*publishedPortfolio);
+                if (!records.empty()) journal.push(move(records));
+            }
+            journal.close();
+        });
+
+        thread journalStage([&] {
+            LogJournal logJournal;
+            vector<LogRecord> records;
+            while (journal.pop(records)) {
+                logJournal.write(records);
+                summary.logLines += records.size();
+            }
+        });
+
+        parseStage.join();
+        riskStage.join();
+        executeStage.join();
+        journalStage.join();
+
+        summary.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout.clear();
+        return summary;
+    }
+
+    static bool parseLine(const string& line, BatchCommand& command) {
+        const char* p = line.c_str();
+        char* end;
+        string word = nextWord(p);
+        if (word == "BUY" || word == "SELL") {
+            command.kind = word == "BUY" ? BatchCommand::BUY : BatchCommand::SELL;
+            command.symbol = nextWord(p);
+            if (!parseInt(p, command.quantity) || command.symbol.empty()) return false;
+            command.limitPrice = strtod(p, &end);
+            command.type = end == p ? OrderType::MARKET : OrderType::LIMIT;
+            p = end;
+        } else if (word == "STRATEGY") {
+            command.kind = BatchCommand::STRATEGY;
+            if (!parseInt(p, command.strategy)) return false;
+        } else {
+            return false;
+        }
+        while (isspace((unsigned char)*p)) ++p;
+        return *p == '\0';
+    }
+
+    static bool decodeFrame(const OrderFrame& frame, BatchCommand& command) {
+        if (frame.command == 1 || frame.command == 2) {
+            command.kind = frame.command == 1 ? BatchCommand::BUY : BatchCommand::SELL;
+            if (frame.orderType > 1) return false;
+            command.type = frame.orderType == 0 ? OrderType::MARKET : OrderType::LIMIT;
+            command.symbol.assign(frame.symbol, strnlen(frame.symbol, sizeof(frame.symbol)));
+            command.quantity = frame.quantity;
+            command.limitPrice = frame.limitPrice;
+            return true;
+        }
+        if (frame.command == 3) {
+            command.kind = BatchCommand::STRATEGY;
+            command.strategy = frame.strategy;
+            return true;
+        }
+        return false;
+    }
+
+    // Risk checks run before anything touches the portfolio; fills in the current price
+    static bool validateCommand(BatchCommand& command, const unordered_map<string, vector<MarketDataLoader::MarketData>>& marketData) {
+        if (command.kind == BatchCommand::STRATEGY) {
+            return command.strategy >= 1 && command.strategy <= 5;
+        }
+        auto it = marketData.find(command.symbol);
+        if (it == marketData.end() || it->second.empty()) return false;
+        if (command.quantity <= 0 || command.quantity > MAX_ORDER_QUANTITY) return false;
+        if (command.type == OrderType::LIMIT && !(command.limitPrice > 0.0)) return false;
+        command.currentPrice = it->second.back().closePrice;
+        return true;
+    }
+
+    // Sends a validated buy/sell command to the engine; limit orders are IOC, so whatever can't fill
+    // at the current price is cancelled rather than left on a book nothing will update
+    static ManagedOrder executeOrderCommand(TradeEngine& engine, const BatchCommand& command) {
+        Side side = command.kind == BatchCommand::BUY ? Side::BUY : Side::SELL;
+        double limitPrice = command.type == OrderType::LIMIT ? command.limitPrice : 0.0;
+        return engine.placeOrder(command.symbol, side, command.quantity, limitPrice, command.currentPrice, TimeInForce::IOC);
+    }
+
+private:
+    TradeEngine& engine;
+    MarketDataLoader& loader;
+    const unordered_map<string, vector<MarketDataLoader::MarketData>>& marketData;
+    SharedMemoryPublisher* publisher = nullptr;
+    const Portfolio* publishedPortfolio = nullptr;
+
+    static string nextWord(const char*& p) {
+        while (isspace((unsigned char)*p)) ++p;
+        const char* begin = p;
+        while (*p != '\0' && !isspace((unsigned char)*p)) ++p;
+        return string(begin, p);
+    }
+
+    // False if there is no number or it does not fit in an int, rather than wrapping it
+    static bool parseInt(const char*& p, int& value) {
+        char* end;
+        errno = 0;
+        long parsed = strtol(p, &end, 10);
+        if (end == p || errno == ERANGE || parsed < INT_MIN || parsed > INT_MAX) return false;
+        value = (int)parsed;
+        p = end;
+        return true;
+    }
+
+    static void parseText(istream& input, BoundedQueue<vector<BatchCommand>>& out, Summary& summary) {
+        vector<BatchCommand> batch;
+        batch.reserve(BATCH_SIZE);
+        string line;
+        while (getline(input, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            size_t first = line.find_first_not_of(" \t");
+            if (first == string::npos || line[first] == '#') continue;
+
+            ++summary.read;
+            BatchCommand command;
+            if (!parseLine(line, command)) {
+                ++summary.parseErrors;
+                continue;
+            }
+            batch.push_back(move(command));
+            if (batch.size() == BATCH_SIZE) {
+                out.push(move(batch));
+                batch = vector<BatchCommand>();
+                batch.reserve(BATCH_SIZE);
+            }
+        }
+        if (!batch.empty()) out.push(move(batch));
+    }
+
+    static void parseBinary(istream& input, BoundedQueue<vector<BatchCommand>>& out, Summary& summary) {
+        vector<OrderFrame> frames(BATCH_SIZE);
+        while (input) {
+            input.read(reinterpret_cast<char*>(frames.data()), frames.size() * sizeof(OrderFrame));
+            size_t count = input.gcount() / sizeof(OrderFrame);
+            if (input.gcount() % sizeof(OrderFrame) != 0) ++summary.parseErrors;  // truncated trailing frame
+
+            vector<BatchCommand> batch;
+            batch.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                ++summary.read;
+                BatchCommand command;
+                if (!decodeFrame(frames[i], command)) {
+                    ++summary.parseErrors;
+                    continue;
+                }
+                batch.push_back(move(command));
+            }
+            if (!batch.empty()) out.push(move(batch));
+        }
+    }
+
+    void execute(const BatchCommand& command, vector<LogRecord>& records, streambuf* consoleBuffer, Summary& summary) {
+        if (command.kind == BatchCommand::STRATEGY) {
+            // Keep the strategy's report and journal it
+            stringstream report;
+            cout.rdbuf(report.rdbuf());  // also clears the failed state
+            runStrategy(command.strategy);
+            cout.rdbuf(consoleBuffer);
+            cout.setstate(ios::badbit);
+
+            string line;
+            while (getline(report, line)) {
+                records.push_back({"strategy_log.txt", line});
+            }
+            ++summary.strategiesRun;
+            return;
+        }
+
+        ManagedOrder order = executeOrderCommand(engine, command);
+        if (order.state == OrderState::FILLED) ++summary.ordersFilled;
+        else ++summary.ordersNotFilled;
+    }
+
+    void runStrategy(int choice) {
+        if (choice == 1) {
+            MovingAverageStrategy maStrategy(10);
+            engine.executeStrategy(&maStrategy, marketData);
+        } else if (choice == 2) {
+            RSIStrategy rsiStrategy(14, 30.0, 70.0);
+            engine.executeStrategy(&rsiStrategy, marketData);
+        } else if (choice == 3) {
+            MeanReversionStrategy mrStrategy(10, 0.05);
+            engine.executeStrategy(&mrStrategy, marketData);
+        } else if (choice == 4) {
+            MomentumStrategy momentumStrategy(10);
+            engine.executeStrategy(&momentumStrategy, marketData);
+        } else {
+            PipelineStrategy<ProductionPipeline> combinedStrategy;
+            engine.executeStrategy(&combinedStrategy, marketData);
+        }
+    }
+};
+
+// Usage: main --batch <file|-> [--binary] [--stats latency.json]
+int runBatch(int argc, char* argv[], MarketDataLoader& loader, const unordered_map<string, vector<MarketDataLoader::MarketData>>& marketData) {
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " --batch <file|-> [--binary] [--stats latency.json]" << endl;
+        return 1;
+    }
+    string source = argv[2];
+    bool binary = false;
+    string statsFile;
+    for (int i = 3; i < argc; ++i) {
+        string flag = argv[i];
+        if (flag == "--binary") binary = true;
+        else if (flag == "--stats" && i + 1 < argc) statsFile = argv[++i];
+        else {
+            cout << "Unknown batch option: " << flag << endl;
+            return 1;
+        }
+    }
+
+    ifstream file;
+    if (source != "-") {
+        file.open(source, binary ? ios::binary : ios::in);
+        if (!file.is_open()) {
+            cout << "Error: Could not open command file " << source << endl;
+            return 1;
+        }
+    }
+    istream& input = source == "-" ? cin : file;
+
+    Portfolio portfolio(100000);
+    portfolio.setAutoSave(false);  // saved once when the run finishes
+    TradeEngine engine(loader, portfolio);
+    BatchProcessor processor(engine, loader, marketData);
+    SharedMemoryPublisher publisher;
+    if (publisher.open()) {
+        publisher.publishBars(marketData);
+        publisher.publishPositions(portfolio);
+        processor.publishTo(&publisher, &portfolio);
+    }
+    BatchProcessor::Summary summary = processor.run(input, binary);
+    portfolio.savePortfolio();
+
+    cout << "Commands read: " << summary.read << endl;
+    cout << "Parse errors: " << summary.parseErrors << endl;
+    cout << "Rejected by risk checks: " << summary.rejected << endl;
+    cout << "Orders filled: " << summary.ordersFilled << endl;
+    cout << "Orders not filled: " << summary.ordersNotFilled << endl;
+    cout << "Strategies run: " << summary.strategiesRun << endl;
+    cout << "Log lines written: " << summary.logLines << endl;
+    cout << "Elapsed: " << summary.seconds << " s (" << (summary.seconds > 0 ? summary.read / summary.seconds : 0.0) << " commands/s)" << endl;
+
+    if (!statsFile.empty()) {
+        ofstream stats(statsFile);
+        if (!stats.is_open()) {
+            cout << "Error: Could not open " << statsFile << " for writing." << endl;
+            return 1;
+        }
+        stats << LatencyProfiler::toJson() << endl;
+    }
+    return 0;
+}
+
+// ---------------- Order-entry server ----------------
+#ifdef __linux__
+
+// Reply to every OrderFrame, sent back in the order the frames were received
+#pragma pack(push, 1)
+struct AckFrame {
+    uint8_t status;          // 0 = filled, 1 = not filled, 2 = rejected
+    uint8_t command;         // echoed from the request
+    uint16_t reserved;
+    int32_t filledQuantity;
+    double fillPrice;
+};
+#pragma pack(pop)
+static_assert(sizeof(AckFrame) == 16, "AckFrame must stay 16 bytes");
+
+enum AckStatus : uint8_t { ACK_FILLED = 0, ACK_NOT_FILLED = 1, ACK_REJECTED = 2, ACK_STATUS_COUNT };
+
+// "unix:/path" selects a Unix socket, anything else is a TCP port on 127.0.0.1
+int connectOrderSocket(const string& address) {
+    int fd;
+    if (address.rfind("unix:", 0) == 0) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, address.c_str() + 5, sizeof(addr.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+    } else {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)atoi(address.c_str()));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
 
-    ifstream logFile("log.txt");
-    if (!logFile.is_open()) {
-        cout << "Error: Could not open transaction log file." << endl;
-        return;
+volatile sig_atomic_t serverStopRequested = 0;
+
+void requestServerStop(int) {
+    serverStopRequested = 1;
+}
+
+// Single threaded epoll event loop in front of TradeEngine.
+// Every readable connection has all of its complete frames decoded and executed as one batch,
+// and the acks go back with a single write. Connection buffers are reused for the life of the connection;
+// a client that stops reading its acks stops being read from, so its ack backlog stays bounded.
+class OrderServer {
+public:
+    struct Stats {
+        long long connections = 0, frames = 0, filled = 0, notFilled = 0, rejected = 0;
+    };
+
+    OrderServer(TradeEngine& eng, const unordered_map<string, vector<MarketDataLoader::MarketData>>& data)
+        : engine(eng), marketData(data) {}
+
+    ~OrderServer() {
+        for (auto& entry : connections) close(entry.first);
+        if (listenFd >= 0) close(listenFd);
+        if (epollFd >= 0) close(epollFd);
+        if (!unixPath.empty()) unlink(unixPath.c_str());
     }
 
-    string logLine;
-    double totalProfit = 0.0;
-    double totalLoss = 0.0;
+    // Publish positions to shared memory after every round of events that executed orders
+    void publishTo(SharedMemoryPublisher* pub, const Portfolio* pf) {
+        publisher = pub;
+        publishedPortfolio = pf;
+    }
 
-    while (getline(logFile, logLine)) {
-        string transactionType, orderType, symbol;
-        int quantity;
-        double price, totalValue;
+    bool listenOn(const string& address) {
+        if (address.rfind("unix:", 0) == 0) {
+            string path = address.substr(5);
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+            // Replace a stale socket from an earlier run, but never anything else at that path
+            struct stat info;
+            if (lstat(path.c_str(), &info) == 0) {
+                if (!S_ISSOCK(info.st_mode)) {
+                    errno = ENOTSOCK;
+                    return false;
+                }
+                unlink(path.c_str());
+            }
+            listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+            if (listenFd < 0 || bind(listenFd, (sockaddr*)&addr, sizeof(addr)) < 0) return false;
+            unixPath = path;  // ours to unlink on shutdown
+        } else {
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons((uint16_t)atoi(address.c_str()));
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);  // local processes only
+            listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+            int one = 1;
+            if (listenFd < 0) return false;
+            setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) < 0) return false;
+        }
+        if (listen(listenFd, 128) < 0) return false;
+
+        epollFd = epoll_create1(0);
+        if (epollFd < 0) return false;
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = listenFd;
+        return epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) == 0;
+    }
 
-        parseLogLine(logLine, transactionType, orderType, symbol, quantity, price, totalValue);
+    // Runs until SIGINT/SIGTERM
+    Stats run() {
+        vector<epoll_event> events(256);
+        vector<LogRecord> records;
+        LogJournal journal;
+        capturedLogs = &records;
+
+        while (!serverStopRequested) {
+            int ready = epoll_wait(epollFd, events.data(), (int)events.size(), 200);
+            if (ready < 0 && errno != EINTR) break;
+
+            for (int i = 0; i < ready; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == listenFd) {
+                    acceptConnections();
+                    continue;
+                }
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    closeConnection(fd);
+                    continue;
+                }
+                if ((events[i].events & EPOLLOUT) && !flushConnection(fd)) continue;
+                if (events[i].events & EPOLLIN) readConnection(fd);
+            }
 
-        if (transactionType == "SELL") {
-            double currentPrice = loader.getLatestPrice(symbol,marketData);
-            double profitLoss = totalValue - quantity * currentPrice;
-            if (profitLoss > 0) {
-                totalProfit += profitLoss;
-            } else {
-                totalLoss += profitLoss;
+            // Journal and publish everything executed in this round of events
+            if (!records.empty()) {
+                journal.write(records);
+                records.clear();
+            }
+            if (publisher != nullptr && stats.frames != publishedFrames) {
+                publisher->publishPositions(*publishedPortfolio);
+                publishedFrames = stats.frames;
+            }
+        }
+
+        capturedLogs = nullptr;
+        journal.flush();
+        return stats;
+    }
+
+private:
+    static constexpr size_t READ_BUFFER_SIZE = 64 * 1024;
+    // Stop reading from a client once this many ack bytes are waiting for it. One read can add at most
+    // READ_BUFFER_SIZE / sizeof(OrderFrame) acks on top, so out never outgrows its initial reservation.
+    static constexpr size_t MAX_PENDING_ACKS = 64 * 1024;
+
+    struct Connection {
+        vector<char> in;    // received bytes, begins at a frame boundary
+        size_t inUsed = 0;
+        vector<char> out;   // encoded acks not yet written
+        size_t outSent = 0;
+        uint32_t interest = EPOLLIN;  // events currently registered with epoll
+    };
+
+    TradeEngine& engine;
+    const unordered_map<string, vector<MarketDataLoader::MarketData>>& marketData;
+    SharedMemoryPublisher* publisher = nullptr;
+    const Portfolio* publishedPortfolio = nullptr;
+    long long publishedFrames = 0;
+    unordered_map<int, Connection> connections;
+    int listenFd = -1;
+    int epollFd = -1;
+    string unixPath;
+    Stats stats;
+
+    void acceptConnections() {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK);
+            if (fd < 0) return;
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));  // fails harmlessly on Unix sockets
+
+            Connection& connection = connections[fd];
+            connection.in.resize(READ_BUFFER_SIZE);
+            connection.out.reserve(MAX_PENDING_ACKS + READ_BUFFER_SIZE / sizeof(OrderFrame) * sizeof(AckFrame));
+
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+            ++stats.connections;
+        }
+    }
+
+    void closeConnection(int fd) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        connections.erase(fd);
+    }
+
+    void readConnection(int fd) {
+        Connection& connection = connections[fd];
+        while (true) {
+            ssize_t n = read(fd, connection.in.data() + connection.inUsed, connection.in.size() - connection.inUsed);
+            if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                closeConnection(fd);
+                return;
+            }
+            if (n < 0) break;
+            connection.inUsed += n;
+
+            // Drop acks already written so the backlog, not the history, is what out holds
+            if (connection.outSent > 0) {
+                connection.out.erase(connection.out.begin(), connection.out.begin() + connection.outSent);
+                connection.outSent = 0;
             }
+
+            // Decode and execute every complete frame in the buffer
+            size_t frameCount = connection.inUsed / sizeof(OrderFrame);
+            for (size_t i = 0; i < frameCount; ++i) {
+                OrderFrame frame;
+                memcpy(&frame, connection.in.data() + i * sizeof(OrderFrame), sizeof(frame));
+                AckFrame ack = handle(frame);
+                const char* bytes = reinterpret_cast<const char*>(&ack);
+                connection.out.insert(connection.out.end(), bytes, bytes + sizeof(ack));
+            }
+
+            // Keep any partial frame at the front of the buffer
+            size_t consumed = frameCount * sizeof(OrderFrame);
+            memmove(connection.in.data(), connection.in.data() + consumed, connection.inUsed - consumed);
+            connection.inUsed -= consumed;
+            if ((size_t)n < connection.in.size()) break;
+            if (connection.out.size() - connection.outSent >= MAX_PENDING_ACKS) break;  // client is behind
         }
+        flushConnection(fd);
     }
 
-    logFile.close();
+    AckFrame handle(const OrderFrame& frame) {
+        ++stats.frames;
+        AckFrame ack{};
+        ack.command = frame.command;
+
+        BatchCommand command;
+        if (!BatchProcessor::decodeFrame(frame, command) || command.kind == BatchCommand::STRATEGY
+            || !BatchProcessor::validateCommand(command, marketData)) {
+            ack.status = ACK_REJECTED;
+            ++stats.rejected;
+            return ack;
+        }
 
-    cout << "Total Profit: $" << totalProfit << endl;
-    cout << "Total Loss: $" << totalLoss << endl;
+        ManagedOrder order = BatchProcessor::executeOrderCommand(engine, command);
+        ack.filledQuantity = order.filledQuantity;
+        ack.fillPrice = order.averagePrice;
+        if (order.state == OrderState::FILLED) {
+            ack.status = ACK_FILLED;
+            ++stats.filled;
+        } else {
+            ack.status = ACK_NOT_FILLED;
+            ++stats.notFilled;
+        }
+        return ack;
+    }
+
+    // Returns false if the connection was closed
+    bool flushConnection(int fd) {
+        Connection& connection = connections[fd];
+        while (connection.outSent < connection.out.size()) {
+            ssize_t n = write(fd, connection.out.data() + connection.outSent, connection.out.size() - connection.outSent);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                closeConnection(fd);
+                return false;
+            }
+            connection.outSent += n;
+        }
+
+        size_t pending = connection.out.size() - connection.outSent;
+        if (pending == 0) {
+            connection.out.clear();
+            connection.outSent = 0;
+        }
+
+        // Wait for writability while acks are queued, and only read while the backlog is under the cap
+        uint32_t interest = (pending < MAX_PENDING_ACKS ? (uint32_t)EPOLLIN : 0u) | (pending > 0 ? (uint32_t)EPOLLOUT : 0u);
+        if (interest != connection.interest) {
+            connection.interest = interest;
+            epoll_event event{};
+            event.events = interest;
+            event.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+        }
+        return true;
+    }
+};
+
+// Usage: main --serve <port|unix:path> [--stats latency.json]
+int runServer(int argc, char* argv[], MarketDataLoader& loader, const unordered_map<string, vector<MarketDataLoader::MarketData>>& marketData) {
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " --serve <port|unix:path> [--stats latency.json]" << endl;
+        return 1;
+    }
+    string address = argv[2];
+    string statsFile = argc > 4 && string(argv[3]) == "--stats" ? argv[4] : "";
+
+    Portfolio portfolio(100000);
+    portfolio.setAutoSave(false);  // saved once on shutdown
+    TradeEngine engine(loader, portfolio);
+    OrderServer server(engine, marketData);
+    SharedMemoryPublisher publisher;
+    if (publisher.open()) {
+        publisher.publishBars(marketData);
+        publisher.publishPositions(portfolio);
+        server.publishTo(&publisher, &portfolio);
+    }
+    if (!server.listenOn(address)) {
+        cout << "Error: Could not listen on " << address << ": " << strerror(errno) << endl;
+        return 1;
+    }
+
+    signal(SIGINT, requestServerStop);
+    signal(SIGTERM, requestServerStop);
+    signal(SIGPIPE, SIG_IGN);
+    cout << "Order server listening on " << address << " (Ctrl+C to stop)" << endl;
+
+    // Engine messages would dominate the latency, so the console stays quiet while serving
+    cout.setstate(ios::badbit);
+    OrderServer::Stats stats = server.run();
+    cout.clear();
+    portfolio.savePortfolio();
+
+    cout << "Connections: " << stats.connections << ", Frames: " << stats.frames << ", Filled: " << stats.filled
+         << ", Not filled: " << stats.notFilled << ", Rejected: " << stats.rejected << endl;
+    if (!statsFile.empty()) {
+        ofstream stats(statsFile);
+        stats << LatencyProfiler::toJson() << endl;
+    }
+    return 0;
 }
 
-// *****************************************************************************
+// Drives a running order server over loopback and reports round trip latency and throughput.
+// Each connection keeps up to `window` orders in flight.
+// Usage: main --loadgen <port|unix:path> [--orders N] [--connections C] [--window W]
+int runLoadGenerator(int argc, char* argv[]) {
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " --loadgen <port|unix:path> [--orders N] [--connections C] [--window W]" << endl;
+        return 1;
+    }
+    string address = argv[2];
+    long long orderCount = 200000;
+    int connectionCount = 1, window = 64;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        string flag = argv[i];
+        if (flag == "--orders") orderCount = atoll(argv[i + 1]);
+        else if (flag == "--connections") connectionCount = atoi(argv[i + 1]);
+        else if (flag == "--window") window = atoi(argv[i + 1]);
+        else {
+            cout << "Unknown load generator option: " << flag << endl;
+            return 1;
+        }
+    }
+    if (orderCount <= 0 || connectionCount <= 0 || window <= 0) {
+        cout << "Load generator sizes must be positive." << endl;
+        return 1;
+    }
+
+    const vector<string> symbols = {"AAPL", "GOOG", "AMZN", "TSLA", "MSFT", "BABA", "DIS", "META", "NFLX", "NVDA"};
+    vector<vector<uint32_t>> latencies(connectionCount);  // nanoseconds
+    vector<long long> statusCounts(ACK_STATUS_COUNT, 0);
+    mutex statusMutex;
+    atomic<bool> failed(false);
+
+    auto worker = [&](int id) {
+        int fd = connectOrderSocket(address);
+        if (fd < 0) {
+            failed = true;
+            return;
+        }
+        long long toSend = orderCount / connectionCount + (id < orderCount % connectionCount ? 1 : 0);
+        vector<chrono::steady_clock::time_point> sentAt(window);  // ring indexed by order number
+        vector<uint32_t>& samples = latencies[id];
+        samples.reserve(toSend);
+        vector<char> in(sizeof(AckFrame) * window);
+        size_t inUsed = 0;
+        vector<OrderFrame> frames(window);
+        long long sent = 0, received = 0;
+        long long counts[ACK_STATUS_COUNT] = {};
+
+        while (received < toSend) {
+            // Top the window up with one write
+            int batch = 0;
+            while (sent + batch < toSend && sent + batch - received < window) {
+                OrderFrame& frame = frames[batch];
+                memset(&frame, 0, sizeof(frame));
+                long long n = sent + batch;
+                frame.command = n % 2 == 0 ? 1 : 2;
+                frame.orderType = 0;
+                const string& symbol = symbols[(n / 2) % symbols.size()];  // buy then sell each symbol
+                memcpy(frame.symbol, symbol.data(), min(symbol.size(), sizeof(frame.symbol)));
+                frame.quantity = 1;
+                sentAt[n % window] = chrono::steady_clock::now();
+                ++batch;
+            }
+            if (batch > 0) {
+                size_t bytes = batch * sizeof(OrderFrame);
+                const char* data = reinterpret_cast<const char*>(frames.data());
+                for (size_t off = 0; off < bytes;) {
+                    ssize_t n = write(fd, data + off, bytes - off);
+                    if (n <= 0) {
+                        failed = true;
+                        close(fd);
+                        return;
+                    }
+                    off += n;
+                }
+                sent += batch;
+            }
+
+            ssize_t n = read(fd, in.data() + inUsed, in.size() - inUsed);
+            if (n <= 0) {
+                failed = true;
+                close(fd);
+                return;
+            }
+            inUsed += n;
+            auto now = chrono::steady_clock::now();
+            size_t acks = inUsed / sizeof(AckFrame);
+            for (size_t i = 0; i < acks; ++i) {
+                AckFrame ack;
+                memcpy(&ack, in.data() + i * sizeof(AckFrame), sizeof(ack));
+                if (ack.status < ACK_STATUS_COUNT) ++counts[ack.status];
+                samples.push_back((uint32_t)min<long long>(UINT32_MAX, chrono::duration_cast<chrono::nanoseconds>(now - sentAt[received % window]).count()));
+                ++received;
+            }
+            memmove(in.data(), in.data() + acks * sizeof(AckFrame), inUsed - acks * sizeof(AckFrame));
+            inUsed -= acks * sizeof(AckFrame);
+        }
+        close(fd);
+
+        lock_guard<mutex> lock(statusMutex);
+        for (int s = 0; s < ACK_STATUS_COUNT; ++s) statusCounts[s] += counts[s];
+    };
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (int c = 0; c < connectionCount; ++c) {
+        threads.emplace_back(worker, c);
+    }
+    for (auto& th : threads) th.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (failed) {
+        cout << "Error: Connection to " << address << " failed or was closed." << endl;
+        return 1;
+    }
+
+    vector<uint32_t> all;
+    for (auto& samples : latencies) all.insert(all.end(), samples.begin(), samples.end());
+    sort(all.begin(), all.end());
+    auto percentile = [&](double q) { return all[min(all.size() - 1, (size_t)(q * all.size()))] / 1000.0; };
+
+    cout << fixed << setprecision(1);
+    cout << "Orders: " << all.size() << " over " << connectionCount << " connection(s), window " << window << endl;
+    cout << "Filled: " << statusCounts[ACK_FILLED] << ", Not filled: " << statusCounts[ACK_NOT_FILLED] << ", Rejected: " << statusCounts[ACK_REJECTED] << endl;
+    cout << "Round trip (us): p50 " << percentile(0.50) << ", p99 " << percentile(0.99) << ", p999 " << percentile(0.999)
+         << ", max " << all.back() / 1000.0 << endl;
+    cout << "Throughput: " << all.size() / seconds << " orders/s" << endl;
+    return 0;
+}
+
+#endif
+
+// ---------------- Shared-memory feed tools ----------------
+#ifdef __linux__
+
+// Prints one consistent snapshot of a running feed
+// Usage: main --feed-read [name]
+int runFeedReader(int argc, char* argv[]) {
+    string name = argc > 2 ? argv[2] : feed::DEFAULT_FEED_NAME;
+    feed::FeedReader reader;
+    if (!reader.open(name.c_str())) {
+        cout << "Error: No market feed published at " << name << endl;
+        return 1;
+    }
+
+    feed::AccountSnapshot account;
+    if (reader.readAccount(account)) {
+        cout << "Cash Balance: $" << account.cashBalance << " (update " << account.updates << ")" << endl;
+    }
+    for (int i = 0; i < reader.symbolCount(); ++i) {
+        feed::BarSnapshot bar;
+        feed::PositionSnapshot position;
+        cout << reader.symbolName(i);
+        if (reader.readBar(i, bar)) {
+            cout << " - " << formatDate(bar.day) << " Close: $" << bar.close;
+        }
+        if (reader.readPosition(i, position) && position.quantity != 0) {
+            cout << " - Quantity: " << position.quantity << " - Purchase Price: $" << position.purchasePrice;
+        }
+        cout << endl;
+    }
+    return 0;
+}
+
+// Reader/writer throughput of the seqlock slots: readers alone, then with one writer
+// rewriting every bar slot as fast as it can.
+// Usage: main --bench-feed [--readers N] [--symbols S] [--millis T]
+int runFeedBenchmark(int argc, char* argv[]) {
+    int readerCount = 4, symbolCount = 64, millis = 1000;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        string flag = argv[i];
+        if (flag == "--readers") readerCount = atoi(argv[i + 1]);
+        else if (flag == "--symbols") symbolCount = atoi(argv[i + 1]);
+        else if (flag == "--millis") millis = atoi(argv[i + 1]);
+        else {
+            cout << "Unknown feed benchmark option: " << flag << endl;
+            return 1;
+        }
+    }
+    if (readerCount <= 0 || millis <= 0 || symbolCount <= 0 || symbolCount > feed::MAX_SYMBOLS) {
+        cout << "Feed benchmark needs positive sizes and at most " << feed::MAX_SYMBOLS << " symbols." << endl;
+        return 1;
+    }
+
+    const string name = "/tms_feed_bench";
+    SharedMemoryPublisher publisher;
+    if (!publisher.open(name)) {
+        cout << "Error: Could not create shared memory region " << name << endl;
+        return 1;
+    }
+    SyntheticMarket generator(7);
+    vector<string> symbols;
+    vector<MarketDataLoader::MarketData> bars = generator.bars(symbolCount);
+    for (int s = 0; s < symbolCount; ++s) {
+        symbols.push_back(SyntheticMarket::symbolName(s));
+        publisher.publishBar(symbols[s], bars[s]);
+    }
+
+    struct Phase {
+        string name;
+        long long reads = 0, retries = 0, writes = 0;
+        double seconds = 0;
+    };
+
+    auto runPhase = [&](const string& phaseName, bool withWriter) {
+        Phase phase;
+        phase.name = phaseName;
+        atomic<bool> stop(false);
+        vector<long long> reads(readerCount, 0), retries(readerCount, 0);
+        atomic<int> ready(0);
+
+        vector<thread> readers;
+        for (int r = 0; r < readerCount; ++r) {
+            readers.emplace_back([&, r] {
+                feed::FeedReader reader;  // each reader maps the region itself, like a separate process would
+                if (!reader.open(name.c_str())) return;
+                ++ready;
+                feed::BarSnapshot bar;
+                long long count = 0, failed = 0;
+                for (int slot = r % symbolCount; !stop.load(memory_order_relaxed); slot = (slot + 1) % symbolCount) {
+                    if (!reader.tryReadBar(slot, bar)) {
+                        ++failed;  // count reads that had to retry, not individual spins
+                        reader.readBar(slot, bar);
+                    }
+                    ++count;
+                }
+                reads[r] = count;
+                retries[r] = failed;
+            });
+        }
+        while (ready.load() < readerCount) this_thread::yield();
+
+        thread writer;
+        long long writes = 0;
+        if (withWriter) {
+            writer = thread([&] {
+                for (int slot = 0; !stop.load(memory_order_relaxed); slot = (slot + 1) % symbolCount) {
+                    bars[slot].closePrice += 0.01;
+                    publisher.publishBar(symbols[slot], bars[slot]);
+                    ++writes;
+                }
+            });
+        }
+
+        auto start = chrono::steady_clock::now();
+        this_thread::sleep_for(chrono::milliseconds(millis));
+        stop = true;
+        for (auto& th : readers) th.join();
+        if (writer.joinable()) writer.join();
+        phase.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        for (int r = 0; r < readerCount; ++r) {
+            phase.reads += reads[r];
+            phase.retries += retries[r];
+        }
+        phase.writes = writes;
+        return phase;
+    };
+
+    vector<Phase> phases = {runPhase("readers_only", false), runPhase("readers_with_writer", true)};
+
+    cout << fixed << setprecision(1);
+    cout << "{\n  \"config\": {\"readers\": " << readerCount << ", \"symbols\": " << symbolCount << ", \"millis\": " << millis << "},\n  \"results\": [\n";
+    for (size_t i = 0; i < phases.size(); ++i) {
+        const Phase& phase = phases[i];
+        cout << "    {\"name\": \"" << phase.name << "\", \"reads_per_sec\": " << phase.reads / phase.seconds
+             << ", \"writes_per_sec\": " << phase.writes / phase.seconds
+             << ", \"ns_per_read\": " << phase.seconds * 1e9 * readerCount / max(1LL, phase.reads)
+             << ", \"retried_read_ratio\": " << setprecision(6) << (double)phase.retries / max(1LL, phase.reads)
+             << setprecision(1) << "}" << (i + 1 < phases.size() ? ",\n" : "\n");
+    }
+    cout << "  ]\n}" << endl;
+    return 0;
+}
+
+#endif
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        return runBenchmarks(argc, argv);
+    }
+#ifdef __linux__
+    if (argc > 1 && string(argv[1]) == "--feed-read") {
+        return runFeedReader(argc, argv);
+    }
+    if (argc > 1 && string(argv[1]) == "--bench-feed") {
+        return runFeedBenchmark(argc, argv);
+    }
+#endif
+    if (argc > 1 && string(argv[1]) == "--loadgen") {
+#ifdef __linux__
+        return runLoadGenerator(argc, argv);
+#else
+        cout << "The load generator is only available on Linux." << endl;
+        return 1;
+#endif
+    }
 
-int main() {
     vector<string> companies = {"AAPL", "GOOG", "AMZN", "TSLA", "MSFT","BABA","DIS","META","NFLX","NVDA"};
     MarketDataLoader loader;
     unordered_map<string, vector<MarketDataLoader::MarketData>> marketData = loader.loadMarketData(companies);
 
+    if (argc > 1 && string(argv[1]) == "--batch") {
+        return runBatch(argc, argv, loader, marketData);
+    }
+    if (argc > 1 && string(argv[1]) == "--serve") {
+#ifdef __linux__
+        return runServer(argc, argv, loader, marketData);
+#else
+        cout << "The order server is only available on Linux." << endl;
+        return 1;
+#endif
+    }
+
+    MarketDataIndex dateIndex(marketData);
+
     Portfolio portfolio(100000); // Initial balance
     TradeEngine engine(loader, portfolio);
 
+    // Let co-located processes see prices and positions (see market_feed.h)
+    SharedMemoryPublisher publisher;
+    if (publisher.open()) {
+        publisher.publishBars(marketData);
+        publisher.publishPositions(portfolio);
+    }
+
     // Displaying the menu
     int choice;
     do {
         displayMenu();
-        cin >> choice;
+        if (!(cin >> choice)) break;  // end of input
 
         switch (choice) {
             case 1: {
@@ -728,7 +3591,7 @@ int main() {
                 // cout << "Enter stock symbol: ";
                 for(auto it: companies)
                 {
-                    cout<<it<<" : $"<<loader.getLatestPrice(it,marketData)<<endl;
+                    cout<<it<<" : $"<<engine.currentPrice(it, loader.getLatestPrice(it,marketData))<<endl;
                 }
                 // string symbol;
                 // cin >> symbol;
@@ -746,7 +3609,7 @@ int main() {
                 cout << "Enter quantity: ";
                 cin >> quantity;
 
-                double currentPrice = loader.getLatestPrice(symbol, marketData);
+                double currentPrice = engine.currentPrice(symbol, loader.getLatestPrice(symbol, marketData));
                 MarketOrder marketOrder(symbol, quantity);
                 engine.executeOrder(&marketOrder, currentPrice);
                 
@@ -758,7 +3621,7 @@ int main() {
                 int quantity;
                 double price;
                 cin >> symbol;
-                double currentPrice = loader.getLatestPrice(symbol, marketData);
+                double currentPrice = engine.currentPrice(symbol, loader.getLatestPrice(symbol, marketData));
                 cout<<"Current share price of "<<symbol<<" : "<<currentPrice<<endl;
                 cout << "Enter limit price: ";
                 cin >> price;
@@ -777,25 +3640,49 @@ int main() {
                     << "2: RSI" << endl
                     << "3: Mean Reversion" << endl
                     << "4: Momentum" << endl
+                    << "5: All four (combined)" << endl
                     << "Enter your choice: ";
                 int strategyChoice;
                 cin >> strategyChoice;
 
+                cout << "Choose timeframe" << endl
+                    << "1: Daily" << endl
+                    << "2: Weekly" << endl
+                    << "3: Monthly" << endl
+                    << "Enter your choice: ";
+                int timeframeChoice;
+                cin >> timeframeChoice;
+
+                unordered_map<string, vector<MarketDataLoader::MarketData>> resampledData;
+                if (timeframeChoice == 2) {
+                    resampledData = BarAggregator::resampleAll(marketData, Timeframe::WEEKLY);
+                } else if (timeframeChoice == 3) {
+                    resampledData = BarAggregator::resampleAll(marketData, Timeframe::MONTHLY);
+                } else if (timeframeChoice != 1) {
+                    cout << "Invalid timeframe choice." << endl;
+                    break;
+                }
+                const auto& strategyData = timeframeChoice == 1 ? marketData : resampledData;
+
                 if (strategyChoice == 1) {
                     MovingAverageStrategy maStrategy(10); // 10-day moving average
-                    engine.executeStrategy(&maStrategy, marketData);
+                    engine.executeStrategy(&maStrategy, strategyData);
                 }
                 else if (strategyChoice == 2) {
                     RSIStrategy rsiStrategy(14, 30.0, 70.0); // 14-day RSI, buy threshold 30, sell threshold 70
-                    engine.executeStrategy(&rsiStrategy, marketData);
+                    engine.executeStrategy(&rsiStrategy, strategyData);
                 }
                 else if (strategyChoice == 3) {
                     MeanReversionStrategy mrStrategy(10, 0.05); // 10-day moving average, 5% deviation threshold
-                    engine.executeStrategy(&mrStrategy, marketData);
+                    engine.executeStrategy(&mrStrategy, strategyData);
                 }
                 else if (strategyChoice == 4) {
                     MomentumStrategy momentumStrategy(10); // 10-day momentum period
-                    engine.executeStrategy(&momentumStrategy, marketData);
+                    engine.executeStrategy(&momentumStrategy, strategyData);
+                }
+                else if (strategyChoice == 5) {
+                    PipelineStrategy<ProductionPipeline> combinedStrategy; // same settings as 1-4, evaluated in one pass
+                    engine.executeStrategy(&combinedStrategy, strategyData);
                 }
                 else {
                     cout << "Invalid strategy choice." << endl;
@@ -811,7 +3698,7 @@ int main() {
                 cout << "Enter quantity to sell: ";
                 cin >> quantity;
 
-                double currentPrice = loader.getLatestPrice(symbol, marketData);
+                double currentPrice = engine.currentPrice(symbol, loader.getLatestPrice(symbol, marketData));
                 engine.MarketSell(symbol, quantity, currentPrice);
                 
                 break;
@@ -827,27 +3714,213 @@ int main() {
                 cout << "Enter limit price: ";
                 cin >> price;
 
-                double currentPrice = loader.getLatestPrice(symbol, marketData);
+                double currentPrice = engine.currentPrice(symbol, loader.getLatestPrice(symbol, marketData));
                 engine.LimitSell(symbol, quantity, price, currentPrice);
                 
                 break;
             }
+            case 9: {
+                cout << "Enter stock symbol: ";
+                string symbol, fromDate, toDate;
+                cin >> symbol;
+                cout << "Enter start date (YYYY-MM-DD): ";
+                cin >> fromDate;
+                cout << "Enter end date (YYYY-MM-DD): ";
+                cin >> toDate;
+
+                if (parseDate(fromDate) == INT_MIN || parseDate(toDate) == INT_MIN) {
+                    cout << "Invalid date." << endl;
+                    break;
+                }
+
+                MarketDataIndex::Span bars = dateIndex.range(symbol, fromDate, toDate);
+                if (bars.empty()) {
+                    cout << "No market data for " << symbol << " between " << fromDate << " and " << toDate << endl;
+                    break;
+                }
+                for (const auto& bar : bars) {
+                    cout << bar.date << "  Open: $" << bar.openPrice << "  High: $" << bar.highPrice
+                         << "  Low: $" << bar.lowPrice << "  Close: $" << bar.closePrice << "  Volume: " << (long long)bar.volume << endl;
+                }
+                break;
+            }
+            case 10: {
+                cout << "Enter date (YYYY-MM-DD): ";
+                string date;
+                cin >> date;
+
+                int day = parseDate(date);
+                if (day == INT_MIN) {
+                    cout << "Invalid date." << endl;
+                    break;
+                }
+
+                vector<const MarketDataLoader::MarketData*> bars = dateIndex.slice(day);
+                const vector<string>& symbols = dateIndex.getSymbols();
+                for (size_t i = 0; i < symbols.size(); ++i) {
+                    if (bars[i] == nullptr) {
+                        cout << symbols[i] << " : no data" << endl;
+                    } else if (bars[i]->day != day) {
+                        cout << symbols[i] << " : $" << bars[i]->closePrice << " (last traded " << bars[i]->date << ")" << endl;
+                    } else {
+                        cout << symbols[i] << " : $" << bars[i]->closePrice << endl;
+                    }
+                }
+                break;
+            }
+            case 11: {
+                LatencyProfiler::printSummary();
+
+                ofstream statsFile("latency.json");
+                if (statsFile.is_open()) {
+                    statsFile << LatencyProfiler::toJson() << endl;
+                    cout << "Latency statistics written to latency.json" << endl;
+                } else {
+                    cout << "Error: Could not open latency.json for writing." << endl;
+                }
+                break;
+            }
+            case 12: {
+                OrderRequest request;
+                string side, type, timeInForce;
+                cout << "Enter stock symbol: ";
+                cin >> request.symbol;
+                double currentPrice = engine.currentPrice(request.symbol, loader.getLatestPrice(request.symbol, marketData));
+                cout << "Current share price of " << request.symbol << " : " << currentPrice << endl;
+                // Words are case-insensitive; anything unknown cancels the order before it is placed
+                auto readWord = [](const char* prompt, string& word) {
+                    cout << prompt;
+                    cin >> word;
+                    transform(word.begin(), word.end(), word.begin(), ::toupper);
+                };
+
+                readWord("Side (BUY/SELL): ", side);
+                if (side == "BUY") request.side = Side::BUY;
+                else if (side == "SELL") request.side = Side::SELL;
+                else {
+                    cout << "Unknown side " << side << "." << endl;
+                    break;
+                }
+                readWord("Type (MARKET/LIMIT/STOP/STOP_LIMIT/TRAILING_STOP): ", type);
+                if (type == "MARKET") request.type = OrderType::MARKET;
+                else if (type == "LIMIT") request.type = OrderType::LIMIT;
+                else if (type == "STOP") request.type = OrderType::STOP;
+                else if (type == "STOP_LIMIT") request.type = OrderType::STOP_LIMIT;
+                else if (type == "TRAILING_STOP") request.type = OrderType::TRAILING_STOP;
+                else {
+                    cout << "Unknown order type " << type << "." << endl;
+                    break;
+                }
+                readWord("Time in force (IOC/FOK/DAY/GTC): ", timeInForce);
+                if (timeInForce == "IOC") request.timeInForce = TimeInForce::IOC;
+                else if (timeInForce == "FOK") request.timeInForce = TimeInForce::FOK;
+                else if (timeInForce == "DAY") request.timeInForce = TimeInForce::DAY;
+                else if (timeInForce == "GTC") request.timeInForce = TimeInForce::GTC;
+                else {
+                    cout << "Unknown time in force " << timeInForce << "." << endl;
+                    break;
+                }
+
+                cout << "Enter quantity: ";
+                cin >> request.quantity;
+                if (request.type == OrderType::STOP || request.type == OrderType::STOP_LIMIT) {
+                    cout << "Enter stop price: ";
+                    cin >> request.stopPrice;
+                }
+                if (request.type == OrderType::LIMIT || request.type == OrderType::STOP_LIMIT) {
+                    cout << "Enter limit price: ";
+                    cin >> request.limitPrice;
+                }
+                if (request.type == OrderType::TRAILING_STOP) {
+                    cout << "Enter trail amount ($): ";
+                    cin >> request.trailAmount;
+                }
+
+                ManagedOrder order = engine.submitOrder(request, currentPrice);
+                cout << "Order " << order.id << " (" << orderTypeName(request.type) << ", " << timeInForceName(request.timeInForce)
+                     << "): " << orderStateName(order.state) << ", filled " << order.filledQuantity << "/" << request.quantity << endl;
+                break;
+            }
+            case 13: {
+                vector<const ManagedOrder*> open = engine.getOrderManager().getOpenOrders();
+                if (open.empty()) {
+                    cout << "No open orders." << endl;
+                    break;
+                }
+                for (const ManagedOrder* order : open) {
+                    const OrderRequest& request = order->request;
+                    cout << "#" << order->id << "  " << (request.side == Side::BUY ? "BUY " : "SELL ") << request.quantity << " "
+                         << request.symbol << "  " << orderTypeName(request.type) << " " << timeInForceName(request.timeInForce);
+                    if (request.stopPrice > 0) cout << "  stop $" << request.stopPrice;
+                    if (request.limitPrice > 0) cout << "  limit $" << request.limitPrice;
+                    if (request.trailAmount > 0) cout << "  trail $" << request.trailAmount;
+                    cout << "  " << orderStateName(order->state) << " (" << order->filledQuantity << " filled)" << endl;
+                }
+                cout << "Enter an order id to cancel, or 0 to keep them all: ";
+                long long id;
+                cin >> id;
+                ManagedOrder cancelled;
+                if (id == 0) {
+                    break;
+                } else if (engine.cancelOrder(id, cancelled)) {
+                    cout << "Order #" << cancelled.id << " " << orderStateName(cancelled.state) << " with "
+                         << cancelled.filledQuantity << " of " << cancelled.request.quantity << " shares filled." << endl;
+                } else {
+                    cout << "No open order with that id." << endl;
+                }
+                break;
+            }
+            case 14: {
+                cout << "Enter stock symbol: ";
+                string symbol;
+                double price;
+                cin >> symbol;
+                cout << "Enter new price: ";
+                cin >> price;
+                if (marketData.count(symbol) == 0 || marketData[symbol].empty() || !(price > 0.0)) {
+                    cout << "Invalid symbol or price." << endl;
+                    break;
+                }
+                engine.onPriceUpdate(symbol, price);
+
+                // Readers of the feed see the price orders now execute against
+                MarketDataLoader::MarketData bar = marketData[symbol].back();
+                bar.closePrice = price;
+                bar.highPrice = max(bar.highPrice, price);
+                bar.lowPrice = min(bar.lowPrice, price);
+                publisher.publishBar(symbol, bar);
+                break;
+            }
+            case 15: {
+                vector<ManagedOrder> expired = engine.endOfDay();
+                for (const ManagedOrder& order : expired) {
+                    cout << "Order #" << order.id << " " << orderStateName(order.state) << " with " << order.filledQuantity
+                         << " of " << order.request.quantity << " shares of " << order.request.symbol << " filled." << endl;
+                }
+                cout << expired.size() << " open DAY order(s) expired; GTC orders remain." << endl;
+                break;
+            }
             case 8:
                 cout << "Exiting..." << endl;
-                exit(0);
                 break;
             default:
                 cout << "Invalid choice! Try again.\n";
         }
+        publisher.publishPositions(portfolio);
+        if (choice == 8) break;
         while(1){
             cout<<endl;
             cout<<"Enter 0 to display menu again or enter 8 to exit"<<endl;
             string flag;
-            cin>>flag;
+            if(!(cin>>flag)){
+                choice = 8;  // end of input
+                break;
+            }
             if(flag=="0") break;
             else if(flag=="8"){
                 cout<<"Exiting...Bye!";
-                exit(0);
+                choice = 8;
+                break;
             }
             else{
                 cout<<"Invalid Choice, Try Again !!"<<endl;
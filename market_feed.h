@@ -0,0 +1,165 @@
+// Shared-memory market data and position feed.
+//
+// The trading system publishes the latest bar and the current position for every symbol into a
+// POSIX shared-memory region. Each slot is guarded by a seqlock: the writer bumps the slot's
+// sequence to an odd value, writes, then bumps it to even again, and readers retry until they
+// copy a slot with the same even sequence before and after. Readers never take a lock or make a
+// system call once the region is mapped.
+//
+// Reader example:
+//     feed::FeedReader reader;
+//     if (reader.open()) {
+//         int aapl = reader.findSymbol("AAPL");
+//         feed::BarSnapshot bar;
+//         if (aapl >= 0 && reader.readBar(aapl, bar)) printf("%s %.2f\n", bar.symbol, bar.close);
+//     }
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace feed {
+
+constexpr uint32_t FEED_MAGIC = 0x464D5354;  // "TSMF"
+constexpr uint32_t FEED_VERSION = 1;
+constexpr int MAX_SYMBOLS = 256;
+constexpr int SYMBOL_LENGTH = 16;
+constexpr const char* DEFAULT_FEED_NAME = "/tms_feed";
+
+struct BarSnapshot {
+    char symbol[SYMBOL_LENGTH];
+    int32_t day;  // days since 1970-01-01
+    double open, high, low, close, volume;
+    double rsi, movingAvg;
+};
+
+struct PositionSnapshot {
+    char symbol[SYMBOL_LENGTH];
+    int32_t quantity;
+    double purchasePrice;
+};
+
+struct AccountSnapshot {
+    double cashBalance;
+    uint64_t updates;  // incremented on every position publish
+};
+
+// One writer, any number of readers. The copy of `value` races with the writer by design;
+// the sequence check discards any copy that overlapped a write.
+template<class T>
+struct alignas(64) SeqlockSlot {
+    std::atomic<uint32_t> sequence;
+    T value;
+
+    void store(const T& next) {
+        uint32_t s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&value, &next, sizeof(T));
+        sequence.store(s + 2, std::memory_order_release);
+    }
+
+    // Single attempt, false if a write was in progress or overlapped the copy
+    bool tryLoad(T& out) const {
+        uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1) return false;
+        std::memcpy(&out, &value, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return sequence.load(std::memory_order_relaxed) == before;
+    }
+
+    // Retries until a consistent copy is read. False if the slot was never written, or if it
+    // stayed mid-write for the whole retry budget (e.g. the writer died during a store).
+    bool load(T& out, int maxAttempts = 1 << 20) const {
+        for (int attempt = 0; attempt < maxAttempts; ++attempt) {
+            if (tryLoad(out)) return sequence.load(std::memory_order_relaxed) != 0;
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        }
+        return false;
+    }
+};
+
+struct SymbolEntry {
+    char symbol[SYMBOL_LENGTH];  // written once, before the entry is counted in symbolCount
+    SeqlockSlot<BarSnapshot> bar;
+    SeqlockSlot<PositionSnapshot> position;
+};
+
+struct FeedRegion {
+    std::atomic<uint32_t> magic;  // set last, once the region is initialised
+    uint32_t version;
+    std::atomic<uint32_t> symbolCount;
+    SeqlockSlot<AccountSnapshot> account;
+    SymbolEntry symbols[MAX_SYMBOLS];
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "feed needs address-free atomics");
+
+// Maps a published feed read-only
+class FeedReader {
+public:
+    FeedReader() = default;
+    FeedReader(const FeedReader&) = delete;
+    FeedReader& operator=(const FeedReader&) = delete;
+    ~FeedReader() { close(); }
+
+    bool open(const char* name = DEFAULT_FEED_NAME) {
+        close();
+        int fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) < 0 || (size_t)info.st_size < sizeof(FeedRegion)) {
+            ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, sizeof(FeedRegion), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) return false;
+
+        region = static_cast<const FeedRegion*>(mapped);
+        if (region->magic.load(std::memory_order_acquire) != FEED_MAGIC || region->version != FEED_VERSION) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (region != nullptr) {
+            munmap(const_cast<FeedRegion*>(region), sizeof(FeedRegion));
+            region = nullptr;
+        }
+    }
+
+    bool isOpen() const { return region != nullptr; }
+
+    int symbolCount() const { return (int)region->symbolCount.load(std::memory_order_acquire); }
+
+    const char* symbolName(int index) const { return region->symbols[index].symbol; }
+
+    // Slot index for a symbol, -1 if it has not been published
+    int findSymbol(const char* symbol) const {
+        int count = symbolCount();
+        for (int i = 0; i < count; ++i) {
+            if (std::strncmp(region->symbols[i].symbol, symbol, SYMBOL_LENGTH) == 0) return i;
+        }
+        return -1;
+    }
+
+    bool readBar(int index, BarSnapshot& out) const { return region->symbols[index].bar.load(out); }
+    bool tryReadBar(int index, BarSnapshot& out) const { return region->symbols[index].bar.tryLoad(out); }
+    bool readPosition(int index, PositionSnapshot& out) const { return region->symbols[index].position.load(out); }
+    bool readAccount(AccountSnapshot& out) const { return region->account.load(out); }
+
+private:
+    const FeedRegion* region = nullptr;
+};
+
+}  // namespace feed